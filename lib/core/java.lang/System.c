@@ -65,9 +65,11 @@ java_lang_System_arraycopy(struct Hjava_lang_Object* src, jint srcpos, struct Hj
 	}
 
 	/* Make sure we'll keep in the array boundaries */
-	if ((srcpos < 0 || srcpos + len > ARRAY_SIZE(src)) ||
-	    (dstpos < 0 || dstpos + len > ARRAY_SIZE(dst)) ||
-	    (len < 0)) {
+	/* Compare with the remaining lengths so that a large LEN cannot
+	   overflow the sums */
+	if ((len < 0) ||
+	    (srcpos < 0 || len > ARRAY_SIZE(src) - srcpos) ||
+	    (dstpos < 0 || len > ARRAY_SIZE(dst) - dstpos)) {
 		SignalError(0, "java.lang.ArrayIndexOutOfBoundsException", "");
 	}
 
@@ -83,12 +85,10 @@ java_lang_System_arraycopy(struct Hjava_lang_Object* src, jint srcpos, struct Hj
 	out = &((char*)ARRAY_DATA(dst))[dstpos];
 
 	if (sclass == dclass) {
-//#if defined(HAVE_MEMMOVE)
-/*
-#ifdef 0
+#if defined(HAVE_MEMMOVE)
+		/* memmove() handles overlapping copies within one array */
 		memmove((void*)out, (void*)in, len);
 #else
-*/
 		/* Do it ourself */
 #if defined(HAVE_MEMCPY)
 		if (src != dst) {
@@ -110,9 +110,7 @@ java_lang_System_arraycopy(struct Hjava_lang_Object* src, jint srcpos, struct Hj
 				*--out = *--in;
 			}
 		}
-/*
 #endif
-*/
 		return;
 	}
 
@@ -21,6 +21,7 @@
 #include "java.lang.stubs/Throwable.h"
 
 extern Hjava_lang_Object* buildStackTrace(void*);
+extern Hjava_lang_Object* resolveStackTrace(Hjava_lang_Object*);
 
 /*
  * Print a line for a stack trace.
@@ -69,7 +70,9 @@ java_lang_Throwable_printStackTrace0(struct Hjava_lang_Throwable* o,
 {
 	jword *trace;
 
-	trace = (jword*)unhand(o)->backtrace;
+	/* Find the methods only now, and only once. */
+	trace = (jword*)resolveStackTrace(unhand(o)->backtrace);
+	unhand(o)->backtrace = (Hjava_lang_Object*)trace;
 
 	if (trace != NULL) {
 		int i, n;
@@ -19,12 +19,37 @@
 #include "lookup.h"
 
 
+void* intrp_resolve_constant (Method*, int, void**);
 void* intrp_resolve_class (Method*, int, void**);
 void* intrp_resolve_method (Method*, int, void**);
 int   intrp_resolve_field (Method*, int, void**);
 int   intrp_resolve_static_field (Method*, int, void**);
 
 
+/* Name        : intrp_resolve_constant
+   Description : Resolve constant for ldc and ldc_w.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
+   Notes:
+     Constant strings are converted into java strings here.  Zero
+     integers and floats are never seen as resolved, so they come
+     here every time, but they are rare in ldc. */
+void*
+intrp_resolve_constant (Method* m, int i, void **resolved)
+{
+    constants *pool;
+    void *value;
+
+    pool = CLASS_CONSTANTS(m->class);
+    if (pool->tags[i] == CONSTANT_String
+	|| pool->tags[i] == CONSTANT_ResolvedString)
+	value = resolveConstantString(m->class, i);
+    else
+	value = (void*)pool->data[i];
+
+    *resolved = value;
+    return value;
+}
+
 /* Name        : intrp_resolve_class
    Description : Resolve class reference.
    Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
@@ -36,6 +36,11 @@
 
 #ifdef METHOD_COUNT
 #include "retranslate.h"
+#include "code_sweeper.h"
+#endif
+
+#ifdef INLINE_CACHE
+#include "PolymorphicInlineCache.h"
 #endif
 
 
@@ -98,6 +103,8 @@ void print_invoke_status();
 struct timeval main_start_time;
 extern struct timeval main_start_time;
 extern unsigned long long gctime_total;
+extern struct timeval main_entry_time;
+extern int num_of_classes_before_main;
 extern unsigned long long translation_total;
 void print_time(void);
 
@@ -281,6 +288,10 @@ options(char** argv)
 		 || strcmp(argv[i], "-vtrstats") == 0) {
             atexit(print_trstats);
         }
+        else if (strcmp(argv[i], "-verbosecodeheap") == 0
+		 || strcmp(argv[i], "-vcodeheap") == 0) {
+            atexit(CSW_print_statistics);
+        }
 #endif /* TRANSLATOR */
 
         else if (strcmp(argv[i], "-count") == 0) {
@@ -301,6 +312,24 @@ options(char** argv)
             }
             The_Max_Retranslation_Threshold = parseSize(argv[i]);
         }
+        else if (strcmp(argv[i], "-noosr") == 0) {
+            flag_osr = 0;
+        }
+        else if (strcmp(argv[i], "-osrcount") == 0) {
+            i++;
+            if (argv[i] == 0) {
+                fprintf(stderr,
+                        "Error: No count for -osrcount.\n");
+                exit(1);
+            }
+            The_OSR_Threshold = parseSize(argv[i]);
+        }
+        else if (strcmp(argv[i], "-nodeopt") == 0) {
+            flag_deopt = 0;
+        }
+        else if (strcmp(argv[i], "-noprofile") == 0) {
+            flag_block_profile = 0;
+        }
 #endif /* METHOD_COUNT */
         else if (strcmp(argv[i], "-verify") == 0) {
             flag_verify = 3;
@@ -361,6 +390,30 @@ options(char** argv)
 //             vi_limit = atoi(argv[i]);
 // #endif
         }
+        else if (strcmp(argv[i], "-recordclasses") == 0) {
+            i++;
+            if (argv[i] == 0) {
+                fprintf(stderr, "Error: No file found for -recordclasses option.\n");
+                exit(1);
+            }
+            flag_record_classes = argv[i];
+        }
+        else if (strcmp(argv[i], "-prefetchclasses") == 0) {
+            i++;
+            if (argv[i] == 0) {
+                fprintf(stderr, "Error: No file found for -prefetchclasses option.\n");
+                exit(1);
+            }
+            flag_prefetch_classes = argv[i];
+        }
+        else if (strcmp(argv[i], "-jitlog") == 0) {
+            i++;
+            if (argv[i] == 0) {
+                fprintf(stderr, "Error: No file found for -jitlog option.\n");
+                exit(1);
+            }
+            flag_jit_log = argv[i];
+        }
         else if (strcmp(argv[i], "-vtm") == 0
 		 || strcmp(argv[i], "-verbosetm") == 0) {
             flag_translated_method = 1;
@@ -427,8 +480,20 @@ options(char** argv)
         else if (strcmp(argv[i], "-nolooppeeling") == 0) {
             flag_looppeeling = 0;
         } 
+        else if (strcmp(argv[i], "-noescape") == 0) {
+            flag_no_escape = 1;
+        }
+        else if (strcmp(argv[i], "-noinlinealloc") == 0) {
+            flag_no_inline_alloc = 1;
+        }
         else if (strcmp(argv[i], "-nobackwardsweep") == 0 ) {
-            flag_no_backward_sweep = 1;
+            The_Use_Backward_Sweep_Option = 0;
+        }
+        else if (strcmp(argv[i], "-nolightregalloc") == 0 ) {
+            flag_no_light_regalloc = 1;
+        }
+        else if (strcmp(argv[i], "-nointrinsics") == 0 ) {
+            flag_no_intrinsics = 1;
         }
         else if (strcmp(argv[i], "-noliveanalysis") == 0 ) {
             flag_no_live_analysis = 1;
@@ -460,6 +525,18 @@ options(char** argv)
         }
 #endif /* TRANSLATOR */
 
+#ifdef INLINE_CACHE
+        else if (strcmp(argv[i], "-picsize") == 0) {
+            i++;
+            if (argv[i] == 0) {
+                fprintf(stderr,
+                        "Error: No size for -picsize.\n");
+                exit(1);
+            }
+            The_PIC_Max_Size = atoi(argv[i]);
+        }
+#endif
+
 #ifdef TYPE_ANALYSIS
         else if (strcmp(argv[i], "-nota") == 0 ) {
             The_Use_TypeAnalysis_Flag = 0;
@@ -561,6 +638,9 @@ usage(void)
     fprintf(stderr, "   -verbosegc, -vgc      Print message during garbage collection\n");
     fprintf(stderr, "   -verboseloader, -vloader\n"
 	            "                         Print message while loading classes\n");
+    fprintf(stderr, "   -recordclasses <file> Write the names of loaded classes to file\n");
+    fprintf(stderr, "   -prefetchclasses <file>\n"
+	            "                         Load the classes named in file while idle\n");
 
 #ifdef TRANSLATOR
     fprintf(stderr, "   -verbosejit, -vjit    Print message during JIT code generation\n");
@@ -568,11 +648,13 @@ usage(void)
     fprintf(stderr, "   -verbosecm, -vcm      Prints called methods\n");
     fprintf(stderr, "   -verbosevcg, -vvcg    Prints vcg file for each methods\n");
     fprintf(stderr, "   -verboseasm, -vasm    Prints asm file for each methods\n");
+    fprintf(stderr, "   -jitlog <file>        Append a record for each translation to file\n");
 #endif /* TRANSLATOR */
 
     fprintf(stderr, "   -verboseexception, -vexception\n"
 	            "                         Prints generated exception\n");
-    fprintf(stderr, "   -verbosetime, -vtime  Prints garbage collection and translation time\n");
+    fprintf(stderr, "   -verbosetime, -vtime  Prints garbage collection and translation time,\n"
+                    "                         and the time and classes loaded up to main()\n");
 
 
 
@@ -584,16 +666,33 @@ usage(void)
 #ifdef METHOD_COUNT
     fprintf(stderr, "   -verbosetrstats, -vtrstats\n"
 	            "                         Print translation statistics\n");
+    fprintf(stderr, "   -verbosecodeheap, -vcodeheap\n"
+	            "                         Print code heap occupancy and reclamation\n");
     fprintf(stderr, "   -adapt                Retranslate based on method run count\n");
     fprintf(stderr, "   -count <count>        Retranslate after method runs <count> times\n");
+    fprintf(stderr, "   -osrcount <count>     Replace a running loop on stack after <count>\n"
+	            "                         iterations\n");
+    fprintf(stderr, "   -noosr                Disable on-stack replacement of loops\n");
+    fprintf(stderr, "   -nodeopt              Disable deoptimization of speculatively\n"
+	            "                         inlined code\n");
+    fprintf(stderr, "   -noprofile            Don't profile basic blocks for retranslation\n");
 #endif /* METHOD_COUNT */
 
+#ifdef INLINE_CACHE
+    fprintf(stderr, "   -picsize <size>       Check up to <size> receiver types at a call\n"
+	            "                         site before using the dispatch table\n");
+#endif /* INLINE_CACHE */
+
 #if defined(INTERPRETER) && defined(TRANSLATOR)
     fprintf(stderr, "   -nointrp              Don't use interpreter\n");
 #endif
 
     fprintf(stderr, "   -nocse                Disable common subexpression elimination\n");
     fprintf(stderr, "   -noloopopt            Disable loop invariant code motion\n");
+    fprintf(stderr, "   -noescape             Disable scalar replacement of objects\n");
+    fprintf(stderr, "   -noinlinealloc        Disable inline allocation of objects\n");
+    fprintf(stderr, "   -nolightregalloc      Fully allocate registers in initial translations\n");
+    fprintf(stderr, "   -nointrinsics         Do not inline java.lang.Math methods\n");
     fprintf(stderr, "   -noinlining           Disable method inlining\n");
 
 #ifdef CUSTOMIZATION
@@ -655,6 +754,10 @@ print_time(void)
                   main_start_time.tv_usec) / 1000;
     fprintf(stderr, "Total Execution Time : %.3f sec.\n", 
 	    total_execution_time / 1000.0);
+    fprintf(stderr, "Time to main() : %.3f sec, %d classes loaded.\n",
+            (main_entry_time.tv_sec - main_start_time.tv_sec)
+            + (main_entry_time.tv_usec - main_start_time.tv_usec) / 1000000.0,
+            num_of_classes_before_main);
 
 #ifdef TRANSLATOR
     fprintf(stderr, "Total Translation Time : %.3f sec (%.2f%%).\n", 
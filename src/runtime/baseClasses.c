@@ -31,6 +31,8 @@
 #include "md.h"
 
 #include "class_inclusion_test.h"
+#include "classPrefetch.h"
+#include "flags.h"
 #include "exception_handler.h"
 
 #ifdef TRANSLATOR
@@ -158,6 +160,11 @@ initialiseLaTTe(void)
 
 	/* Initialise the System */
 	do_execute_java_class_method("java.lang.System", "initializeSystemClass", "()V");
+
+	/* Load the classes used by earlier runs while we're idle */
+	if (flag_prefetch_classes != NULL) {
+		startClassPrefetch();
+	}
 }
 
 /*
@@ -0,0 +1,167 @@
+/* classArchive.c
+   Archives of class files which are mapped at startup.
+
+   Written by: Yoo C. Chung <chungyc@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Laboratory, Seoul National University.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#include "config.h"
+#include "config-std.h"
+#include "config-io.h"
+#include "config-mem.h"
+#include "lerrno.h"
+#include "gtypes.h"
+#include "gc.h"
+#include "classArchive.h"
+
+/* Read the 4 byte big-endian number at offset OFF of BASE. */
+#define U4(BASE, OFF)	(((uint32)(BASE)[OFF] << 24)		\
+			 | ((uint32)(BASE)[(OFF)+1] << 16)	\
+			 | ((uint32)(BASE)[(OFF)+2] << 8)	\
+			 | (uint32)(BASE)[(OFF)+3])
+
+/* Must be the same as the one in util/mkclassarchive.pl. */
+static uint32
+hashName (const char *name)
+{
+    uint32 hash = 0;
+
+    while (*name != '\0')
+	hash = hash * 31 + (unsigned char) *name++;
+    return hash;
+}
+
+int
+isClassArchive (unsigned char *buf)
+{
+    return U4(buf, 0) == CLASS_ARCHIVE_MAGIC;
+}
+
+/* Map the whole file, or read it into fixed memory if it can't be
+   mapped.  *MAPPED tells which was done, for unmapFile(). */
+static unsigned char *
+mapFile (int fd, uint32 size, int *mapped)
+{
+    unsigned char *base;
+    uint32 n;
+    int r;
+
+#if defined(HAVE_MMAP)
+    base = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base != (unsigned char *) -1) {
+	*mapped = 1;
+	return base;
+    }
+#endif
+
+    *mapped = 0;
+
+    base = gc_malloc_fixed(size);
+    for (n = 0; n < size; ) {
+	r = read(fd, base + n, size - n);
+	if (r > 0)
+	    n += r;
+	else if (r == 0
+		 || !(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+	    gc_free(base);
+	    return NULL;
+	}
+    }
+    return base;
+}
+
+/* Undo mapFile(). */
+static void
+unmapFile (unsigned char *base, uint32 size, int mapped)
+{
+#if defined(HAVE_MMAP)
+    if (mapped) {
+	munmap(base, size);
+	return;
+    }
+#endif
+    gc_free(base);
+}
+
+int
+openClassArchive (ClassArchive *archive, char *path)
+{
+    unsigned char *base;
+    struct stat sbuf;
+    uint32 index_size;
+    int mapped;
+    int fd;
+
+    fd = open(path, O_RDONLY|O_BINARY);
+    if (fd < 0)
+	return -1;
+    if (fstat(fd, &sbuf) < 0 || sbuf.st_size < CLASS_ARCHIVE_HEADER) {
+	close(fd);
+	return -1;
+    }
+
+    base = mapFile(fd, sbuf.st_size, &mapped);
+    close(fd);
+    if (base == NULL)
+	return -1;
+
+    index_size = U4(base, 12);
+    if (U4(base, 0) != CLASS_ARCHIVE_MAGIC
+	|| U4(base, 4) != CLASS_ARCHIVE_VERSION
+	|| index_size == 0 || (index_size & (index_size - 1)) != 0
+	|| index_size > (sbuf.st_size - CLASS_ARCHIVE_HEADER) / 4) {
+	fprintf(stderr, "Warning: %s is not a valid class archive.\n", path);
+	unmapFile(base, sbuf.st_size, mapped);
+	return -1;
+    }
+
+    archive->size = sbuf.st_size;
+    archive->index_size = index_size;
+    archive->base = base;
+    return 0;
+}
+
+int
+findInClassArchive (ClassArchive *archive, char *name, classFile *hand)
+{
+    unsigned char *base = archive->base;
+    uint32 h, n, entry;
+    uint32 name_offset, name_length, data_offset, data_length;
+    uint32 len = strlen(name);
+
+    /* A broken archive may have no empty slot, so probe each slot
+       at most once. */
+    h = hashName(name) & (archive->index_size - 1);
+    for (n = 0; n < archive->index_size; n++) {
+	entry = U4(base, CLASS_ARCHIVE_HEADER + 4 * h);
+	if (entry == 0)
+	    return 0;
+
+	/* Don't trust the archive too much. */
+	if (entry > archive->size - CLASS_ARCHIVE_ENTRY)
+	    return 0;
+
+	name_offset = U4(base, entry);
+	name_length = U4(base, entry + 4);
+	if (name_length == len
+	    && name_offset < archive->size
+	    && name_length < archive->size - name_offset
+	    && memcmp(name, base + name_offset, len) == 0) {
+	    data_offset = U4(base, entry + 8);
+	    data_length = U4(base, entry + 12);
+	    if (data_offset > archive->size
+		|| data_length > archive->size - data_offset)
+		return 0;
+
+	    hand->base = NULL;
+	    hand->buf = base + data_offset;
+	    hand->size = data_length;
+	    return 1;
+	}
+	h = (h + 1) & (archive->index_size - 1);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+/* classArchive.h
+   Interface to archives of class files which are mapped at startup.
+
+   Written by: Yoo C. Chung <chungyc@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Laboratory, Seoul National University.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#ifndef _classArchive_h_INCLUDED
+#define _classArchive_h_INCLUDED
+
+#include "gtypes.h"
+#include "file.h"
+
+/* A class archive is made by util/mkclassarchive.pl from a list of
+   classes, and can be put in the class path just like a ZIP file.
+   All numbers are 4 bytes long and big-endian, as in class files.
+
+	magic		CLASS_ARCHIVE_MAGIC
+	version		CLASS_ARCHIVE_VERSION
+	count		number of entries
+	index_size	size of the index, a power of two
+	index		offsets of entries, or 0 for empty slots
+	entries		each is name offset, name length,
+			data offset and data length
+	names		NUL terminated names of the entries
+	data		contents of the entries, aligned to 8 bytes
+
+   The index is an open addressed hash table of the entries keyed by
+   name, with linear probing.  The archive is used as it is, so
+   nothing has to be read or built for it at startup, and processes
+   share its pages.
+
+   Only the raw class files are shared.  Each process still parses
+   them into its own Class, Method and Field structures, since those
+   are modified in place after loading and point into the garbage
+   collected heap.  So the archive saves opening and searching the
+   class path and decompressing, not parsing or linking. */
+
+#define CLASS_ARCHIVE_MAGIC	0x4c544341	/* "LTCA" */
+#define CLASS_ARCHIVE_VERSION	1
+
+#define CLASS_ARCHIVE_HEADER	16	/* size of the fields before index */
+#define CLASS_ARCHIVE_ENTRY	16	/* size of an entry */
+
+typedef struct ClassArchive {
+    unsigned char *base;	/* Contents, set last when opened. */
+    uint32 size;
+    uint32 index_size;
+} ClassArchive;
+
+/* Whether BUF, the first 4 bytes of a file, starts a class archive. */
+extern int isClassArchive (unsigned char *buf);
+
+/* Map the archive at PATH.  Returns non-zero on failure. */
+extern int openClassArchive (ClassArchive *archive, char *path);
+
+/* Find the entry NAME in the archive, and point HAND at its contents.
+   Returns zero if there is no such entry. */
+extern int findInClassArchive (ClassArchive *archive, char *name,
+			       classFile *hand);
+
+#endif /* not _classArchive_h_INCLUDED */
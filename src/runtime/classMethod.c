@@ -34,6 +34,7 @@
 #include "locks.h"
 #include "class_inclusion_test.h"
 #include "exception_handler.h"
+#include "flags.h"
 
 #ifdef CUSTOMIZATION
 #include "SpecializedMethod.h"
@@ -74,8 +75,34 @@
 #define	FDBG(s)
 #define	LDBG(s)
 
-#define	CLASSHASHSZ		256	/* Must be a power of two */
-static Hjava_lang_Class* classPool[CLASSHASHSZ];
+/* Classes are kept in a hash table for each class loader, which is
+ * open addressed and grows by doubling.  Lookups don't lock: slots are
+ * only ever filled, and a table is replaced by a complete copy.  The
+ * old copy is not freed, since a lookup may still be reading it. */
+#define	CLASSTABLESZ		256	/* Must be a power of two */
+
+typedef struct classSlots {
+	int		size;
+	struct {
+		uint32			hash;	/* Cached name hash */
+		Hjava_lang_Class*	class;
+	} slot[1];
+} classSlots;
+
+typedef struct classTable {
+	Hjava_lang_ClassLoader*	loader;
+	classSlots*		slots;
+	int			count;
+	struct classTable*	next;
+} classTable;
+
+static classTable* classTables;
+static quickLock classTableLock;	/* Serializes registerClass() */
+static quickLock systemLoadLock;	/* Serializes system class loading */
+
+int num_of_loaded_classes;
+
+static quickLock constStringLock;	/* Serializes resolveConstantString() */
 
 
 unsigned long total_interface = 1;
@@ -217,6 +244,7 @@ processClass(Hjava_lang_Class* class, int tostate)
         verify3(class);
 
         CIT_update_class_hierarchy(class);
+        buildMemberTables(class);
 
         /* And note that it's done */
         SET_CLASS_STATE(CSTATE_LINKED);
@@ -337,34 +365,101 @@ hashClassName(Utf8Const *name)
 #define hashClassName(NAME) ((NAME)->hash)
 #endif
 
+static
+classTable*
+findClassTable(Hjava_lang_ClassLoader* loader)
+{
+    classTable* table;
+
+    for (table = classTables; table != 0; table = table->next) {
+        if (table->loader == loader) {
+            return (table);
+        }
+    }
+    return (0);
+}
+
+static
+classSlots*
+newClassSlots(int size)
+{
+    classSlots* slots;
+
+    slots = gc_malloc_fixed(sizeof(classSlots)
+                            + (size - 1) * sizeof(slots->slot[0]));
+    slots->size = size;
+    return (slots);
+}
+
+/* Enter CL into SLOTS, which must have an empty slot. */
+static
+void
+insertClassSlot(classSlots* slots, Hjava_lang_Class* cl, uint32 hash)
+{
+    int i;
+
+    for (i = hash & (slots->size - 1);
+         slots->slot[i].class != 0;
+         i = (i + 1) & (slots->size - 1))
+        ;
+    /* The hash must be set before the class makes the slot visible */
+    slots->slot[i].hash = hash;
+    slots->slot[i].class = cl;
+}
+
 /*
  * Take a prepared class and register it with the class pool.
  */
 void
 registerClass(Hjava_lang_Class* cl)
 {
-    Hjava_lang_Class** clp;
+    classTable* table;
+    classSlots* slots;
+    classSlots* nslots;
     uint32 hash;
+    int i;
 
-    hash = hashClassName(cl->name) & (CLASSHASHSZ-1);
-
-    /* All classes are entered in the global classPool.
+    /* All classes are entered in the class pool.
      * This is done, even for classes using a ClassLoader, following
      * the prescription of the "Java Language Specification"
      * (section 12.2:  Loading of Classes and Interfaces). */
 
-    clp = &classPool[hash];
-#ifdef DEBUG
-    while (*clp != 0) {
-        assert(! equalUtf8Consts (cl->name, (*clp)->name)
-               || loader != (*clp)->loader);
-        clp = &(*clp)->next;
+    hash = hashClassName(cl->name);
+
+    lockMutex(&classTableLock);
+
+    table = findClassTable(cl->loader);
+    if (table == 0) {
+        table = gc_malloc_fixed(sizeof(classTable));
+        table->loader = cl->loader;
+        table->slots = newClassSlots(CLASSTABLESZ);
+        table->count = 0;
+        table->next = classTables;
+        classTables = table;
     }
+    slots = table->slots;
+
+#ifdef DEBUG
+    assert(simpleLookupClass(cl->name, cl->loader) == 0);
 #endif
-    /* Add into list. */
-    cl->next = *clp;
-    *clp = cl; 
 
+    /* Keep the table at most half full */
+    if (2 * (table->count + 1) > slots->size) {
+        nslots = newClassSlots(2 * slots->size);
+        for (i = 0; i < slots->size; i++) {
+            if (slots->slot[i].class != 0) {
+                insertClassSlot(nslots, slots->slot[i].class,
+                                slots->slot[i].hash);
+            }
+        }
+        table->slots = slots = nslots;
+    }
+
+    insertClassSlot(slots, cl, hash);
+    table->count++;
+    num_of_loaded_classes++;
+
+    unlockMutex(&classTableLock);
 }
 
 static
@@ -573,6 +668,120 @@ addInterfaces(Hjava_lang_Class* c, int inr, Hjava_lang_Class** inf)
     c->interface_len = inr;
 }
 
+/*
+ * Names of system classes which are being loaded but are not yet
+ * registered.  Only used when the class prefetcher is running.
+ */
+typedef struct loadingClass {
+	Utf8Const*		name;
+	Hjava_lang_Thread*	thread;
+	struct loadingClass*	next;
+} loadingClass;
+
+static loadingClass* loadingClasses;	/* Protected by systemLoadLock */
+
+static loadingClass*
+findLoadingClass(Utf8Const* name)
+{
+    loadingClass* lc;
+
+    for (lc = loadingClasses; lc != NULL; lc = lc->next) {
+        if (equalUtf8Consts(lc->name, name)) {
+            return (lc);
+        }
+    }
+    return (NULL);
+}
+
+/*
+ * Load a system class.  When the class prefetcher is running it may
+ * load the same class in another thread, so the first thread to ask
+ * for a class leaves a placeholder for its name, and others wait for
+ * the placeholder to go away rather than reading the class again.
+ * Once the class is registered it is linked under its own loadingLock
+ * as usual, so systemLoadLock is only held to look at the placeholders
+ * and never across processClass(); holding it there would order it
+ * after the loadingLock of the superclass, while resolveConstants()
+ * reaches it with a loadingLock held.
+ *
+ * A class is registered before it is linked, so one which failed to
+ * load is marked erroneous, and later attempts to load it, possibly
+ * from other threads, fail as well.
+ */
+static Hjava_lang_Class*
+loadSystemClass(Utf8Const* name)
+{
+    Hjava_lang_Class* class;
+    loadingClass self;
+    loadingClass** lcp;
+    loadingClass* lc;
+    Hjava_lang_Object* err;
+    int prefetching;
+
+    prefetching = (flag_prefetch_classes != NULL);
+
+    if (!prefetching) {
+        class = simpleLookupClass(name, NULL);
+    }
+    else {
+        lockMutex(&systemLoadLock);
+        for (;;) {
+            class = simpleLookupClass(name, NULL);
+            if (class != NULL) {
+                break;
+            }
+            lc = findLoadingClass(name);
+            if (lc == NULL || lc->thread == currentThread) {
+                break;
+            }
+            waitCond(&systemLoadLock, 0);
+        }
+        if (class == NULL) {
+            self.name = name;
+            self.thread = currentThread;
+            self.next = loadingClasses;
+            loadingClasses = &self;
+        }
+        unlockMutex(&systemLoadLock);
+    }
+
+    if (class != NULL) {
+        if (class->state == CSTATE_ERROR) {
+            throwException(NoClassDefFoundError(name->data));
+        }
+        /* Waits on the class's loadingLock while another thread
+         * links it. */
+        processClass(class, CSTATE_LINKED);
+        return (class);
+    }
+
+    class = (struct Hjava_lang_Class*)newObject(ClassClass);
+    class->name = name;
+    class->state = CSTATE_UNLOADED;
+
+    err = NULL;
+    EH_NATIVE_DURING
+        processClass(class, CSTATE_LINKED);
+    EH_NATIVE_HANDLER
+        class->state = CSTATE_ERROR;
+        err = (Hjava_lang_Object*)captive_exception;
+    EH_NATIVE_ENDHANDLER
+
+    if (prefetching) {
+        lockMutex(&systemLoadLock);
+        for (lcp = &loadingClasses; *lcp != &self; lcp = &(*lcp)->next)
+            ;
+        *lcp = self.next;
+        broadcastCond(&systemLoadLock);
+        unlockMutex(&systemLoadLock);
+    }
+
+    if (err != NULL) {
+        throwExternalException(err);
+    }
+    return (class);
+}
+
 static char loadClassName[] = "loadClass";
 static char loadClassSig[] = "(Ljava/lang/String;Z)Ljava/lang/Class;";
 
@@ -586,7 +795,9 @@ loadClass(Utf8Const* name, Hjava_lang_ClassLoader* loader)
     Hjava_lang_Class* class;
 
     class = simpleLookupClass(name, loader);
-    if (class != NULL) {
+    if (class != NULL
+        && ((class->state >= CSTATE_LINKED && class->state != CSTATE_ERROR)
+            || loader != NULL)) {
         return (class);
     }
 
@@ -604,9 +815,7 @@ LDBG(		printf("classLoader: done %i\n", class->state);			)
         }
     }
     else {
-        class = (struct Hjava_lang_Class*)newObject(ClassClass);
-        class->name = name;
-        class->state = CSTATE_UNLOADED;
+        return (loadSystemClass(name));
     }
 
     processClass(class, CSTATE_LINKED);
@@ -813,8 +1022,7 @@ resolveStaticFields(Hjava_lang_Class* class)
                 break;
 
             case CONSTANT_String:
-                pool->data[idx] = (ConstSlot)Utf8Const2JavaString(WORD2UTF(pool->data[idx]));
-                pool->tags[idx] = CONSTANT_ResolvedString;
+                resolveConstantString(class, idx);
                 /* ... fall through ... */
             case CONSTANT_ResolvedString:
                 *(jref*)mem = (jref)CLASS_CONST_DATA(class, idx);
@@ -1170,6 +1378,7 @@ buildDispatchTable(Hjava_lang_Class* class)
 #ifdef DYNAMIC_CHA
                     mt->isOverridden = true;
                     DCHA_fixup_speculative_call_site(mt);
+                    DCHA_invalidate_dependent_code(mt);
 #endif
                     goto foundmatch;
                 }
@@ -1595,51 +1804,96 @@ fixupTrampoline(Method* meth)
 
 /*
  * Initialise the constants.
- * First we make sure all the constant strings are converted to java strings.
+ * Strings are resolved lazily, when they are first used.
  */
 static
 void
 resolveConstants(Hjava_lang_Class* class)
 {
+#ifdef TRANSLATOR
     int idx;
     constants* pool;
+#endif /* TRANSLATOR */
     
     assert(class->state == CSTATE_LINKED);
     class->state = CSTATE_DOING_CONSTINIT;
 
-    /* Scan constant pool and convert any constant strings into true
-     * java strings.
+    /* Without the translator, constant strings are converted into
+     * true java strings by resolveConstantString() when they are
+     * first used.
      */
+
+	/* The translator is not reentrant, so the constant pool must
+           not be resolved while translating: loading a class may
+           throw with the translator lock held, linking a new
+           subclass can invalidate inlining decisions of the method
+           being translated before its dependencies are registered,
+           and making a string allocates in the middle of a
+           translation.  So under the translator, strings and
+           classes are still resolved here. */
+#ifdef TRANSLATOR
     pool = CLASS_CONSTANTS (class);
     for (idx = 0; idx < pool->size; idx++) {
         if (pool->tags[idx] == CONSTANT_String) {
-            pool->data[idx] = (ConstSlot)Utf8Const2JavaString(WORD2UTF(pool->data[idx]));
-            pool->tags[idx] = CONSTANT_ResolvedString;
+            resolveConstantString(class, idx);
         }
-
-	/* The translator is not reentrant, so problems might arise if
-           classes aren't resolved, especially when custom class
-           loaders are used.  FIXME: This should not be resolved at
-           class loading time! */
-#ifdef TRANSLATOR
         else if (pool->tags[idx] == CONSTANT_Class) {
             getClass(idx, class);
         }
-#endif /* TRANSLATOR */
     }
+#endif /* TRANSLATOR */
 
     class->state = CSTATE_CONSTINIT;
 }
 
+/*
+ * Convert a constant string into a true java string the first time
+ * it is used, and return it.
+ */
+Hjava_lang_String*
+resolveConstantString(Hjava_lang_Class* class, constIndex idx)
+{
+    constants* pool;
+
+    pool = CLASS_CONSTANTS (class);
+    if (pool->tags[idx] != CONSTANT_ResolvedString) {
+        lockMutex(&constStringLock);
+        if (pool->tags[idx] == CONSTANT_String) {
+            pool->data[idx] = (ConstSlot)Utf8Const2JavaString(WORD2UTF(pool->data[idx]));
+            /* The tag is set last, since the data is read without
+               locking once the tag says it is resolved. */
+            pool->tags[idx] = CONSTANT_ResolvedString;
+        }
+        unlockMutex(&constStringLock);
+    }
+    return ((Hjava_lang_String*)pool->data[idx]);
+}
+
 static
 Hjava_lang_Class*
 simpleLookupClass(Utf8Const* name, Hjava_lang_ClassLoader* loader)
 {
+    classTable* table;
+    classSlots* slots;
     Hjava_lang_Class* clp;
+    uint32 hash;
+    int i;
 
-    for (clp = classPool[hashClassName(name) & (CLASSHASHSZ-1)]; clp != 0 && !(equalUtf8Consts(name, clp->name) && loader == clp->loader); clp = clp->next)
-		;
-    return (clp);
+    table = findClassTable(loader);
+    if (table == 0) {
+        return (0);
+    }
+
+    hash = hashClassName(name);
+    slots = table->slots;
+    for (i = hash & (slots->size - 1);
+         (clp = slots->slot[i].class) != 0;
+         i = (i + 1) & (slots->size - 1)) {
+        if (slots->slot[i].hash == hash && equalUtf8Consts(name, clp->name)) {
+            return (clp);
+        }
+    }
+    return (0);
 }
 
 /*
@@ -1649,28 +1903,16 @@ Field*
 lookupClassField(Hjava_lang_Class* clp, Utf8Const* name, bool isStatic)
 {
     Field* fptr;
-    int n;
     
-    /* Search down class for field name */
-    if (isStatic) {
-        fptr = CLASS_SFIELDS(clp);
-        n = CLASS_NSFIELDS(clp);
-    }
-    else {
-        fptr = CLASS_IFIELDS(clp);
-        n = CLASS_NIFIELDS(clp);
-    }
-    while (--n >= 0) {
-        if (equalUtf8Consts (name, fptr->name)) {
-            if (!FIELD_RESOLVED(fptr)) {
-                char* sig;
-                sig = ((Utf8Const*)FIELD_TYPE(fptr))->data;
-                FIELD_TYPE(fptr) = classFromSig(&sig, clp->loader);
-                fptr->accflags &= ~FIELD_UNRESOLVED_FLAG;
-            }
-            return (fptr);
+    fptr = findFieldLocal(clp, name, isStatic);
+    if (fptr != 0) {
+        if (!FIELD_RESOLVED(fptr)) {
+            char* sig;
+            sig = ((Utf8Const*)FIELD_TYPE(fptr))->data;
+            FIELD_TYPE(fptr) = classFromSig(&sig, clp->loader);
+            fptr->accflags &= ~FIELD_UNRESOLVED_FLAG;
         }
-        fptr++;
+        return (fptr);
     }
 FDBG(	printf("Class:field lookup failed %s:%s\n", c, f);		)
     return (0);
@@ -1851,6 +2093,12 @@ registerTypeCheckCode(uintp start_pc, uintp end_pc)
     CN_register_data(start_pc, end_pc, NULL, TypeCheckCode);
 }
 
+void
+deregisterMethod(uintp start_pc, uintp end_pc, void *mi)
+{
+    CN_deregister_data(start_pc, end_pc, mi);
+}
+
 #endif /* TRANSLATOR */
 
 
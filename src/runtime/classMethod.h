@@ -52,10 +52,20 @@ struct TypeCheckerSet_t;
 #define	CSTATE_OK		10
 #define CSTATE_ERROR            11
 
-// For class inclusion test
+// For class inclusion test.  A class whose depth in the class
+// hierarchy is less than TYPE_DISPLAY_SIZE has a nonzero id, which is
+// (depth << 26) | serial, and is found at display[depth] of all of its
+// subclasses.  So (id >> 24) is the byte offset of the id in a display.
+#define TYPE_DISPLAY_SIZE               8
+#define TYPE_ID_OFFSETSHIFT             24
+#define TYPE_ID_DISPLAYOFFSET(ID)       ((ID) >> TYPE_ID_OFFSETSHIFT)
+
 typedef struct _TypeRep {
-    int32       pos;
-    uint32*     row;
+    uint32      id;
+    int32       depth;
+    uint32      display[TYPE_DISPLAY_SIZE];
+    struct Hjava_lang_Class** supers;   /* Interfaces, null terminated */
+    struct Hjava_lang_Class* cache;     /* Last supertype searched for */
 } TypeRep;
 
 typedef struct Hjava_lang_ClassLoader {
@@ -65,9 +75,6 @@ typedef struct Hjava_lang_ClassLoader {
 typedef struct Hjava_lang_Class {
     Hjava_lang_Object head;		/* A class is an object too */
 
-    /* Used to chain classes in the same hash bucket of classPool. */
-    struct Hjava_lang_Class *next;
-
     Utf8Const *name;
     accessFlags accflags;
 
@@ -124,6 +131,11 @@ typedef struct Hjava_lang_Class {
     /* For class inclusion test */
     TypeRep type_rep; 
 
+    /* Hashed tables of the methods and fields, built when linked */
+    struct _memberTable *methodTable;
+    struct _memberTable *fieldTable;
+    uint32 methodNames;		/* Filter of method names, see lookup.c */
+
     /* lock for class loading */
     int loadingLock;
 
@@ -246,6 +258,7 @@ typedef struct _methods {
 #ifdef METHOD_COUNT
     int count;		/* Method run count */
     int tr_level;	/* Number of retranslations done */
+    int backEdgeCount;	/* Loop iterations before on-stack replacement */
 #endif /* METHOD_COUNT */
 
 #endif /* not CUSTOMIZATION */
@@ -254,6 +267,11 @@ typedef struct _methods {
     uint8 bcodeInfo;
     uint8 *bcodeInfos;
 
+#ifdef METHOD_COUNT
+    uint32 *blockCounts;	/* Basic block run counts, array[bpc] */
+    uint32 entryCount;		/* Invocations counted with blockCounts */
+#endif /* METHOD_COUNT */
+
 #ifdef DYNAMIC_CHA
     bool        isOverridden;
     CallSiteSet* callSiteSet;
@@ -265,7 +283,7 @@ typedef struct _methods {
 
 typedef struct _dispatchTable {
     Hjava_lang_Class*	class;
-    uint32*             row;
+    uint32*             display;
     void*		method[1];
 } dispatchTable;
 
@@ -312,6 +330,8 @@ bool Method_IsSynchronized(Method *method);
 
 #define METHOD_JOIN_POINT 0x0001
 #define METHOD_WITHIN_TRY 0x0002
+#define METHOD_LOOP_HEADER 0x0004	/* target of a backward branch */
+#define METHOD_BLOCK_START 0x0008	/* counted by light translations */
 
 void Method_SetBcodeInfo(Method *method, uint8 *bcode);
 uint8 *Method_GetBcodeInfo(Method *method);
@@ -340,7 +360,7 @@ int Method_GetBranchNO(Method *method);
 #define	DTABLE_METHODOFFSET	((int)&(((dispatchTable*)0)->method[0]))
 #define DTABLE_METHODINDEX      DTABLE_METHODOFFSET/(sizeof(unsigned))
 #define	DTABLE_METHODSIZE	(sizeof(void*))
-#define DTABLE_ROWOFFSET        ((int)&(((dispatchTable*)0)->row))
+#define DTABLE_DISPLAYOFFSET    ((int)&(((dispatchTable*)0)->display))
 #define ARRAY_ENCODINGOFFSET    ((int)&(((Array*)0)->encoding))
 
 typedef struct _fields {
@@ -468,6 +488,9 @@ Hjava_lang_Class*	lookupObjectArrayClass(Hjava_lang_Class*);
 Field*			lookupClassField(Hjava_lang_Class*, Utf8Const*, bool);
 
 Hjava_lang_Class*	getClass(constIndex, Hjava_lang_Class*);
+struct Hjava_lang_String* resolveConstantString(Hjava_lang_Class*, constIndex);
+
+extern int		num_of_loaded_classes;
 
 void			countInsAndOuts(char*, short*, short*, char*);
 int			sizeofSig(char**, bool);
@@ -477,6 +500,7 @@ Hjava_lang_Class*	classFromSig(char**, Hjava_lang_ClassLoader*);
 void			finishFields(Hjava_lang_Class*);
 struct MethodInstance*	findMethodFromPC(uintp);
 void			registerMethod(uintp, uintp, void *);
+void			deregisterMethod(uintp, uintp, void *);
 void                    registerTypeCheckCode(uintp start_pc, uintp end_pc);
 Utf8Const*		makeUtf8Const(char*, int);
 
@@ -0,0 +1,90 @@
+/* classPrefetch.c
+   Record the classes loaded by a run, and load them ahead of use in
+   later runs.
+
+   Written by: Junpyo Lee <walker@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Laboratory, Seoul National University.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#include <ctype.h>
+#include "config.h"
+#include "config-std.h"
+#include "config-mem.h"
+#include "gtypes.h"
+#include "classMethod.h"
+#include "thread.h"
+#include "locks.h"
+#include "flags.h"
+#include "exception_handler.h"
+#include "classPrefetch.h"
+
+#define	MAXNAME		256
+
+static FILE *class_record = NULL;
+
+void
+recordLoadedClass (char *cname)
+{
+    if (class_record == NULL) {
+	class_record = fopen(flag_record_classes, "w");
+	if (class_record == NULL) {
+	    perror(flag_record_classes);
+	    flag_record_classes = NULL;		/* don't try again */
+	    return;
+	}
+    }
+    fprintf(class_record, "%s\n", cname);
+    fflush(class_record);
+}
+
+/* The list has a class name such as java/lang/Object on each line,
+   as written by -recordclasses.  Since threads are not preemptive
+   among priorities, this thread runs only while all the others are
+   blocked, and loading a class it has not reached yet is left to the
+   thread which needs it. */
+static void
+prefetchMain (void)
+{
+    char name[MAXNAME];
+    Utf8Const *utf8;
+    FILE *fp;
+    int len;
+
+    /* Threads are started with interrupts disabled. */
+    intsRestore();
+
+    fp = fopen(flag_prefetch_classes, "r");
+    if (fp == NULL) {
+	perror(flag_prefetch_classes);
+	THREAD_EXIT();
+    }
+
+    while (fgets(name, sizeof(name), fp) != NULL) {
+	len = strlen(name);
+	while (len > 0 && isspace((unsigned char) name[len - 1]))
+	    name[--len] = '\0';
+	if (len == 0 || name[0] == '#')
+	    continue;
+
+	utf8 = makeUtf8Const(name, len);
+	EH_NATIVE_DURING
+	    loadClass(utf8, NULL);
+	EH_NATIVE_HANDLER
+	    /* The list may be stale.  loadClass() has marked the class
+	       erroneous, so the thread which really uses it gets a
+	       NoClassDefFoundError. */
+	EH_NATIVE_ENDHANDLER
+    }
+
+    fclose(fp);
+    THREAD_EXIT();
+}
+
+void
+startClassPrefetch (void)
+{
+    createDaemon(&prefetchMain, "prefetcher", java_lang_Thread_MIN_PRIORITY);
+}
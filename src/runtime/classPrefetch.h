@@ -0,0 +1,23 @@
+/* classPrefetch.h
+   Interface to recording the classes loaded by a run, and loading
+   them ahead of use in later runs.
+
+   Written by: Junpyo Lee <walker@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Laboratory, Seoul National University.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#ifndef _classPrefetch_h_INCLUDED
+#define _classPrefetch_h_INCLUDED
+
+/* Append CNAME, such as java/lang/Object, to the file given with
+   -recordclasses. */
+extern void recordLoadedClass (char *cname);
+
+/* Start the thread which loads the classes listed in the file given
+   with -prefetchclasses. */
+extern void startClassPrefetch (void);
+
+#endif /* not _classPrefetch_h_INCLUDED */
@@ -10,175 +10,96 @@
    disclaimer of all warranties. */
 #include <assert.h>
 #include <stdlib.h>
-#include <alloca.h>
+#include <string.h>
 #include "config.h"
 #include "gtypes.h"
 #include "exception.h"
 #include "classMethod.h"
+#include "soft.h"
 #include "gc.h"
 
-extern Hjava_lang_Class* ObjectClass;
 #define  DBG( s )
 #define CIT_MALLOC(SZ, UNIT)  (UNIT*)gc_malloc_fixed((SZ)*sizeof(UNIT))
 
-#define INITIAL_BITVEC_SIZE 5
-#define EXPAND_BITVEC_SIZE  5
+/* Serials must fit below the depth in an id, and are never reused. */
+#define MAX_SERIAL          ((1 << 24) - 1)
+#define DEPTH_SHIFT         26
 
-static int column_idx = 0;
-static int bitvec_size = INITIAL_BITVEC_SIZE;
+static uint32 next_serial = 1;
 
-
-/* classList is used in two cases.
-   1. when BM must be expanded.
-   2. when array class is loaded. */
-typedef struct _classList {
-    Hjava_lang_Class* class;
-    struct _classList* next;
-} classList;
-
-static classList *NormalHead = NULL;
-static classList *ArrayHead = NULL;
-static int32     num_of_array_classes = 0;
-
-
-// static uint32 bit_array[] = {
-//     0x80000000, 0x40000000, 0x20000000, 0x10000000,
-//     0x08000000, 0x04000000, 0x02000000, 0x01000000, 
-//     0x00800000, 0x00400000, 0x00200000, 0x00100000,
-//     0x00080000, 0x00040000, 0x00020000, 0x00010000, 
-//     0x00008000, 0x00004000, 0x00002000, 0x00001000,
-//     0x00000800, 0x00000400, 0x00000200, 0x00000100, 
-//     0x00000080, 0x00000040, 0x00000020, 0x00000010,
-//     0x00000008, 0x00000004, 0x00000002, 0x00000001 
-// };
-
-static inline void
-set_ith_bit(uint32* row, int32 pos)
-{
-    row[pos >> 5] |= (0x1 << (31-(pos & 0x1f)));
-//    row[pos >> 5] |= bit_array[pos & 0x1f];
-}
-
-static inline bool
-is_ith_bit_set(uint32* row, int32 pos)
-{
-    return row[pos >> 5] & (0x1 << (31-(pos & 0x1f)));
-//    return row[pos >> 5] & bit_array[pos & 0x1f];
-}
+/* superList is used to collect the interfaces of a class. */
+typedef struct _superList {
+    Hjava_lang_Class** list;
+    int num;
+    int max;
+} superList;
 
 static void
-_expand_binary_matrix_in_class_list(classList* cl, int prev_size)
+add_super(superList* sl, Hjava_lang_Class* class)
 {
-    while (cl) {
-        TypeRep* type_rep = Class_GetTypeRep(cl->class);
-        uint32* prev_row = type_rep->row;
+    Hjava_lang_Class** new_list;
+    int i;
 
-        type_rep->row = CIT_MALLOC(bitvec_size,uint32);
-        memcpy(type_rep->row, prev_row, prev_size * sizeof(uint32));
-
-        if (Class_GetVirtualTable(cl->class))
-          Class_GetVirtualTable(cl->class)->row = type_rep->row;
-
-        cl = cl->next;
+    for (i = 0; i < sl->num; i++) {
+        if (sl->list[i] == class)
+          return;
     }
-}
 
-static void
-expand_binary_matrix()
-{
-    int prev_size = bitvec_size;
-    
-    bitvec_size += EXPAND_BITVEC_SIZE;
-
-    _expand_binary_matrix_in_class_list(NormalHead, prev_size);
-    _expand_binary_matrix_in_class_list(ArrayHead, prev_size);
-}
-
-inline static int32
-_make_encoding(int32 pos)
-{
-    return ((pos >> 3) << 8) | (0x1 << (7-(pos & 0x7)));
+    if (sl->num == sl->max) {
+        sl->max *= 2;
+        new_list = CIT_MALLOC(sl->max, Hjava_lang_Class*);
+        memcpy(new_list, sl->list, sl->num * sizeof(Hjava_lang_Class*));
+        gc_free(sl->list);
+        sl->list = new_list;
+    }
+    sl->list[sl->num++] = class;
 }
 
 static void
-_update_array_class_hierarchy(Hjava_lang_Class* class)
+add_interfaces(superList* sl, Hjava_lang_Class* class)
 {
-    Hjava_lang_Class* elem_type = Class_GetElementType(class);
-    short       dim = Class_GetDimension(class);
-    TypeRep*    type_rep = Class_GetTypeRep(class);
-    TypeRep*    elem_type_rep = Class_GetTypeRep(elem_type);
-    classList*  cl = ArrayHead;
-
-    /* For array classes whose component is reference type, 
-       we set encoding field to make AASTORE faster */
-    if (!Class_IsPrimitiveType(Class_GetComponentType(class))) {
-        int32 encoding =  
-            _make_encoding(Class_GetTypeRep(Class_GetComponentType(class))->pos);
-        Class_SetEncoding(class, encoding);
-    }
+    int                 num_of_interfaces =
+                          Class_GetNumOfImplementedInterfaces(class);
+    Hjava_lang_Class**  interfaces = Class_GetImplementedInterfaces(class);
+    int                 i;
 
-    while (cl) {
-        Hjava_lang_Class* tmp_class = cl->class;
-        Hjava_lang_Class* tmp_elem_type = Class_GetElementType(tmp_class);
-        short tmp_dim = Class_GetDimension(tmp_class);
-        TypeRep* tmp_type_rep = Class_GetTypeRep(tmp_class);
-        TypeRep* tmp_elem_type_rep = Class_GetTypeRep(tmp_elem_type);
-
-        if (elem_type == ObjectClass) {
-            if (tmp_dim >= dim)
-              set_ith_bit(tmp_type_rep->row, type_rep->pos);
-        } else if (tmp_elem_type == ObjectClass) {
-            if (dim >= tmp_dim)
-              set_ith_bit(type_rep->row, tmp_type_rep->pos);
-        } else if (dim == tmp_dim) {
-            if (Class_IsPrimitiveType(elem_type) 
-                || Class_IsPrimitiveType(tmp_elem_type));
-
-            else if (is_ith_bit_set(elem_type_rep->row, tmp_elem_type_rep->pos))
-              set_ith_bit(type_rep->row, tmp_type_rep->pos);
-            else if (is_ith_bit_set(tmp_elem_type_rep->row, elem_type_rep->pos))
-              set_ith_bit(tmp_type_rep->row, type_rep->pos);
-        }
-        cl = cl->next;
+    for (i = 0; i < num_of_interfaces; i++) {
+        add_super(sl, interfaces[i]);
+        add_interfaces(sl, interfaces[i]);
     }
-
-    /* add this class to the array class list */
-    cl = CIT_MALLOC(1, classList);
-    cl->class = class;
-    cl->next = ArrayHead;
-    ArrayHead = cl;
 }
 
-static void
-_update_normal_class_hierarchy(Hjava_lang_Class* class)
+/* Make the null terminated list of all the interfaces implemented by
+   the class, including those of its superclass. */
+static Hjava_lang_Class**
+make_super_list(Hjava_lang_Class* class)
 {
-    int                 num_of_interfaces =
-	                  Class_GetNumOfImplementedInterfaces(class);
-    Hjava_lang_Class**  interfaces = Class_GetImplementedInterfaces(class);
-    TypeRep*            type_rep = Class_GetTypeRep(class);
-    classList*          cl;
+    Hjava_lang_Class*   superclass = Class_GetSuperclass(class);
+    Hjava_lang_Class**  supers;
+    superList           sl;
 
-    int                 i;
+    sl.num = 0;
+    sl.max = 8;
+    sl.list = CIT_MALLOC(sl.max, Hjava_lang_Class*);
 
-    for (i = 0; i < num_of_interfaces; i++) {
-        Hjava_lang_Class* interface = interfaces[i];
-        int j;
-        for (j = 0; j < bitvec_size; j++) {
-            type_rep->row[j] |= Class_GetTypeRep(interface)->row[j];
-        }
+    if (superclass != NULL && Class_GetTypeRep(superclass)->supers != NULL) {
+        for (supers = Class_GetTypeRep(superclass)->supers;
+             *supers != NULL; supers++)
+          add_super(&sl, *supers);
     }
+    add_interfaces(&sl, class);
 
-    /* add this class to the normal class list */
-    cl = CIT_MALLOC(1, classList);
-    cl->class = class;
-    cl->next = NormalHead;
-    NormalHead = cl;
+    supers = CIT_MALLOC(sl.num + 1, Hjava_lang_Class*);
+    memcpy(supers, sl.list, sl.num * sizeof(Hjava_lang_Class*));
+    supers[sl.num] = NULL;
+    gc_free(sl.list);
 
+    return supers;
 }
-        
+
 /* Name        : CIT_update_class_hierarchy
-   Description : When a class is loaded, the corresponding row of 
-                 the class should be set appropriately.
+   Description : When a class is loaded, the display and the interface
+                 list of the class should be set appropriately.
    Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
    Pre-condition: 
        This function should be called only once per class.
@@ -187,53 +108,96 @@ _update_normal_class_hierarchy(Hjava_lang_Class* class)
    
    Post-condition:
    
-   Notes:  */
+   Notes: Only classes which are neither arrays nor interfaces get an
+          id, since no other type is found at a fixed depth of the
+          display of all its subtypes.  */
 void
 CIT_update_class_hierarchy(Hjava_lang_Class* class)
 {
     Hjava_lang_Class*   superclass = Class_GetSuperclass(class);
     TypeRep *type_rep = Class_GetTypeRep(class);
 
-    if (column_idx >= bitvec_size * 32)
-      expand_binary_matrix();
-
-    type_rep->pos = column_idx++;
+    if (superclass != NULL) {
+        TypeRep* super_rep = Class_GetTypeRep(superclass);
 
-//     /* row need not be allocated for interface */
-//     if (Class_IsInterfaceType(class))
-//       return;
-
-    type_rep->row = CIT_MALLOC(bitvec_size,uint32);
-    if (Class_GetVirtualTable(class))
-      Class_GetVirtualTable(class)->row = type_rep->row;
+        memcpy(type_rep->display, super_rep->display,
+               sizeof(type_rep->display));
+        type_rep->depth = super_rep->depth + 1;
+    } else {
+        memset(type_rep->display, 0, sizeof(type_rep->display));
+        type_rep->depth = 0;
+    }
 
-    if (superclass != NULL)
-      memcpy(type_rep->row, Class_GetTypeRep(superclass)->row, 
-             bitvec_size * sizeof(uint32));
-    /* type inclusion teset is reflexive. */
-    set_ith_bit(type_rep->row, type_rep->pos);
+    type_rep->id = 0;
+    if (!Class_IsArrayType(class) && !Class_IsInterfaceType(class)
+        && type_rep->depth < TYPE_DISPLAY_SIZE && next_serial <= MAX_SERIAL) {
+        type_rep->id = (type_rep->depth << DEPTH_SHIFT) | next_serial++;
+        /* type inclusion test is reflexive. */
+        type_rep->display[type_rep->depth] = type_rep->id;
+    }
 
+    type_rep->cache = NULL;
+    type_rep->supers = make_super_list(class);
 
-    if (Class_IsArrayType(class))
-      _update_array_class_hierarchy(class);
-    else /* normal class */
-      _update_normal_class_hierarchy(class);
+    if (Class_GetVirtualTable(class))
+      Class_GetVirtualTable(class)->display = type_rep->display;
 
+    /* For array classes whose component is reference type, 
+       we set encoding field to make AASTORE faster */
+    if (Class_IsArrayType(class)) {
+        Hjava_lang_Class* component = Class_GetComponentType(class);
+
+        if (!Class_IsPrimitiveType(component))
+          Class_SetEncoding(class, Class_GetTypeRep(component)->id);
+    } else if (Class_GetArrayType(class) != NULL) {
+        /* The array class was made before this class was linked. */
+        Class_SetEncoding(Class_GetArrayType(class), type_rep->id);
+    }
 }
+
 /* Name        : CIT_is_subclass
    Description : check whether class1 is a subclass of class2
    Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
    Pre-condition:
+       CIT_update_class_hierarchy() has been called for class1.
    
    Post-condition:
    
-   Notes:  */
+   Notes: Array types are compared by instanceof_array(), which
+          comes back here for the element types.  */
 bool
 CIT_is_subclass(Hjava_lang_Class* class1, Hjava_lang_Class* class2)
 {
     TypeRep* type_rep1 = Class_GetTypeRep(class1);
     TypeRep* type_rep2 = Class_GetTypeRep(class2);
+    Hjava_lang_Class** supers;
+    Hjava_lang_Class* c;
+
+    if (type_rep2->id != 0)
+      return type_rep1->display[type_rep2->depth] == type_rep2->id;
+
+    if (class1 == class2 || type_rep1->cache == class2)
+      return true;
+
+    if (Class_IsArrayType(class2)) {
+        if (!instanceof_array(class2, class1))
+          return false;
+    } else if (Class_IsInterfaceType(class2)) {
+        if (type_rep1->supers == NULL)
+          return false;
+        for (supers = type_rep1->supers; *supers != class2; supers++) {
+            if (*supers == NULL)
+              return false;
+        }
+    } else {
+        /* class2 is too deep for the display. */
+        for (c = Class_GetSuperclass(class1); c != class2; 
+             c = Class_GetSuperclass(c)) {
+            if (c == NULL)
+              return false;
+        }
+    }
 
-    return is_ith_bit_set(type_rep1->row, type_rep2->pos);
+    type_rep1->cache = class2;
+    return true;
 }
-
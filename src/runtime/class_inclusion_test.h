@@ -1,10 +1,13 @@
 /* class_inclusion_test.h
 
-   To determine subclass relationship between two classes,
-   a bit vector is managed by JVM.
-   When a class is loaded and linked, JVM check if this class is a subclass
-   of each class which has been already loaded.
-   And JVM updates a bit table and when queried, use this table.
+   To determine subclass relationship between two classes, each class
+   has a display of the ids of its superclasses, indexed by their
+   depth in the class hierarchy, and a list of the interfaces it
+   implements.  Both are built once when the class is linked, so the
+   memory used grows only with the number of classes.  A class is
+   tested against a superclass by looking at a single entry of the
+   display.  Interfaces, arrays and classes too deep for the display
+   are searched for, and the last one found is cached.
 
    
    Written by: Junpyo Lee <walker@altair.snu.ac.kr>
@@ -45,6 +45,9 @@
 #include "class_inclusion_test.h"
 #include "reg_alloc_util.h"
 #include "translator_driver.h"
+#ifdef CUSTOMIZATION
+#include "SpecializedMethod.h"
+#endif /* CUSTOMIZATION */
 
 
 #endif /* TRANSLATOR */
@@ -601,6 +604,16 @@ invoke_exception_handler(Hjava_lang_Throwable *eobject,
 	handler_instance->initEHVarMap = mi->initEHVarMap;
 	handler_instance->localVarNO = mi->localVarNO;
 	handler_instance->stackVarNO = mi->stackVarNO;
+
+	/* the handler code lives and dies with the translation which
+	   contains MI */
+	{
+	    MethodInstance *root = mi;
+
+	    while (MI_GetCaller(root) != NULL)
+		root = MI_GetCaller(root);
+	    MI_AddHandlerInstance(root, handler_instance);
+	}
 	
 	translated_code = TI_GetNativeCode(&tiinfo);
 	variable_map = TI_GetInitMap(&tiinfo);
@@ -830,6 +843,167 @@ copy_register_value(int *org_sp, int *org_fp, int *sp, int *fp,
 }
 
 
+#ifdef METHOD_COUNT
+/* Name        : translate_osr_entry
+   Description : translate a method from a loop header as an entry for
+                 on-stack replacement
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       mi is the root method instance of a light translation, and info
+       is the exception information of its back-edge counter at bpc.
+   Post-condition:
+       the new entry is recorded in mi.  its code is NULL if the
+       translated code needs a larger stack frame than frame_size.
+   
+   Notes: the entry is translated like an exception handler, so that it
+          runs in the stack frame of the light translation.  As for
+          handlers, method inlining is disabled unless HANDLER_INLINE
+          is defined (see determine_compilation_flags()); the optimized
+          translation made on the next invocation inlines as usual.  */
+static
+OSREntry *
+translate_osr_entry(MethodInstance *mi, ExceptionInfo *info, int bpc,
+		    int frame_size)
+{
+    TranslationInfo tiinfo = {0, };
+    MethodInstance *osr_instance;
+    OSREntry *entry;
+
+    TI_SetRootMethod(&tiinfo, MI_GetMethod(mi));
+    TI_SetGenMap(&tiinfo, EIT_GetVariableMap(info));
+    TI_SetRetMap(&tiinfo, NULL);
+    TI_SetStartBytecodePC(&tiinfo, bpc);
+    TI_SetOSREntry(&tiinfo);
+    TI_SetCallerLocalNO(&tiinfo, 0);
+    TI_SetCallerStackNO(&tiinfo, 0);
+    TI_SetReturnAddr(&tiinfo, 0);
+    TI_SetReturnStackTop(&tiinfo, -1);
+
+    translate(&tiinfo);
+
+    /* the entry code lives and dies with the light translation */
+    osr_instance = TI_GetRootMethodInstance(&tiinfo);
+    MI_AddHandlerInstance(mi, osr_instance);
+
+    entry = (OSREntry *) gc_malloc_fixed(sizeof(OSREntry));
+    entry->bytecodePC = bpc;
+
+    if (TI_GetFrameSize(&tiinfo) <= frame_size) {
+	int map_size;
+
+	entry->code = TI_GetNativeCode(&tiinfo);
+	entry->localVarNO = TI_GetLocalVarNO(&tiinfo);
+	entry->stackVarNO = TI_GetStackVarNO(&tiinfo);
+
+	/* the entry owns its own copy of the map, which is freed with
+	   it (see reclaim() in code_sweeper.c) */
+	map_size = (entry->localVarNO + entry->stackVarNO + MAX_TEMP_VAR)
+	    * sizeof(int);
+	entry->initMap = (int *) gc_malloc_fixed(map_size);
+	bcopy(TI_GetInitMap(&tiinfo), entry->initMap, map_size);
+    } else {
+	entry->code = NULL;
+    }
+
+    MI_AddOSREntry(mi, entry);
+
+    return entry;
+}
+
+/* Name        : EH_transfer_to_osr_code
+   Description : replace a light translation running a hot loop with
+                 optimized code, which continues from the loop header
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       called from the back-edge counter at a loop header (see
+       CSeq_create_back_edge_count_code()).  owner is the Method or
+       SpecializedMethod which holds the counter.
+   Post-condition:
+       returns to the light code only if on-stack replacement is not
+       possible.
+   
+   Notes: live variables are moved with the same mechanism used when
+          control is transferred to an exception handler.  */
+void
+EH_transfer_to_osr_code(void *owner)
+{
+    register exceptionFrame *stack_frame asm ("%sp");
+    exceptionFrame *frame;
+    void *osr_site;
+    MethodInstance *mi;
+    ExceptionInfoTable *info_table;
+    ExceptionInfo *info;
+    OSREntry *entry;
+    int bpc;
+#ifdef CUSTOMIZATION
+    SpecializedMethod *sm = (SpecializedMethod *) owner;
+#else
+    Method *m = (Method *) owner;
+#endif
+
+    asm volatile("ta 3");
+
+    osr_site = (void *) stack_frame->retpc;
+    frame = (exceptionFrame *) stack_frame->retbp;
+
+    /* Rearm the counter, and make the next invocation of the method
+       retranslate it. */
+#ifdef CUSTOMIZATION
+    sm->backEdgeCount = The_OSR_Threshold;
+    sm->count = 0;
+#else
+    m->backEdgeCount = The_OSR_Threshold;
+    m->count = 0;
+#endif
+
+    mi = findMethodFromPC((uintp) osr_site);
+    if (mi == NULL) return;
+
+    info_table = MI_GetExceptionInfoTable(mi);
+    if (info_table == NULL) return;
+
+    info = EIT_find(info_table, (uintp) osr_site);
+    if (EIT_GetNativePC(info) == 0 || EIT_GetMethodInstance(info) != mi)
+	return;
+
+    bpc = EIT_GetBytecodePC(info);
+
+    entry = MI_FindOSREntry(mi, bpc);
+    if (entry == NULL)
+	entry = translate_osr_entry(mi, info, bpc,
+				    frame->retbp - (int) frame);
+
+    if (entry->code == NULL) return;
+
+    if (flag_jit)
+	fprintf(stderr, "on-stack replacement at %d of %s %s %s\n",
+		bpc, MI_GetMethod(mi)->class->name->data,
+		MI_GetMethod(mi)->name->data,
+		MI_GetMethod(mi)->signature->data);
+
+    /* no variable lives in an out register across the call */
+    bzero(_out_registers, sizeof(_out_registers));
+
+    adjust_variable_values(mi, info, entry->initMap,
+			   entry->localVarNO, entry->stackVarNO, frame);
+
+    asm volatile (
+	"ta      3				\n
+         add     %0, %%g0, %%g1			\n
+         add     %1, %%g0, %%fp			\n
+         add     %2, %%g0, %%g3			\n
+         restore %%g0, %%g0, %%g2		\n
+         ldd     [%%g3],    %%o0		\n
+         ldd     [%%g3+8],  %%o2		\n
+         ldd     [%%g3+16], %%o4		\n
+         jmp     %%g1				\n
+         ldd     [%%sp+56], %%i6		\n"
+	: /* no outputs */
+	: "r" (entry->code), "r" (frame), "r" (out_registers)
+	: "g1", "g2", "g3", "o0", "o1", "o2", "o3", "o4", "o5");
+}
+#endif /* METHOD_COUNT */
+
 /* Name        : append_copy_code
    Description : append copy instructions before entry
    Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
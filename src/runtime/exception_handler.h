@@ -77,4 +77,11 @@ void EH_arithmetic_exception(int sig, siginfo_t *siginfo, ucontext_t *ctx);
 void EH_exception_manager(struct Hjava_lang_Throwable *exception_object,
 			  struct _exceptionFrame *stack_frame);
 
+#ifdef METHOD_COUNT
+/* called from the back-edge counter of a hot loop in lightly
+   translated code.  transfers control to optimized code entered at
+   the loop header if possible. */
+void EH_transfer_to_osr_code(void *owner);
+#endif /* METHOD_COUNT */
+
 #endif __EXCEPTION_HANDLER_H__
@@ -23,6 +23,8 @@
 #include "file.h"
 #include "exception.h"
 #include "zipfile.h"
+#include "classArchive.h"
+#include "classPrefetch.h"
 #include "readClass.h"
 #include "paths.h"
 #include "flags.h"
@@ -39,28 +41,48 @@
 #define	CP_ZIPFILE	1
 #define	CP_DIR		2
 #define	CP_SOFILE	3
+#define	CP_ARCHIVE	4
 
 #define	CLASSSYMPREFIX	"__CLASS_"
 
 #define	IS_ZIP(B)	((B)[0] == 'P' && (B)[1] == 'K')
 
+/* Number of recently inflated entries kept for each zip file, and the
+   largest entry which is kept */
+#define	ZIPCACHESIZE	4
+#define	ZIPCACHEMAX	65536
+
 static struct {
 	int	type;
 	char*	path;
 	union {
 		ZipFile	zipf;
+		ClassArchive arch;
 		struct { 
 			int	loaded;
 		} sof;
 	} u;
+	struct {
+		ZipDirectory*	zipd;
+		char*		data;
+	} cache[ZIPCACHESIZE];
+	int	cachenext;
 } classpath[MAXPATHELEM+1];
 
 char* realClassPath;
 
+/* Serializes opening of archives and loading of libraries in the
+   class path.  Once an archive is indexed, it is searched without
+   the lock. */
+static quickLock jarlock;
+
 void initClasspath(void);
 classFile findInJar(char*);
 
 static int getClasspathType(char*);
+static int openZipArchive(int);
+static int openArchive(int);
+static int inflateZipEntry(int, ZipDirectory*, char*);
 
 /*
  * Find the named class in a directory or zip file.
@@ -79,9 +101,13 @@ CDBG(	printf("Scanning for class %s\n", cname);		)
 
 	/* Find class in Jar file */
 	hand = findInJar(buf);
+	if (flag_record_classes != NULL && hand.type != CP_INVALID) {
+		recordLoadedClass(cname);
+	}
 	switch (hand.type) {
 	case CP_DIR:
 	case CP_ZIPFILE:
+	case CP_ARCHIVE:
 		if (flag_classload) {
 			fprintf(stderr, "Loading class '%s'.\n", cname);
 		}
@@ -121,7 +147,6 @@ CDBG(	printf("Scanning for class %s\n", cname);		)
 classFile
 findInJar(char* cname)
 {
-	static quickLock jarlock;
 	int i;
 	char buf[MAXBUF];
 	int fp;
@@ -129,59 +154,68 @@ findInJar(char* cname)
 	classFile hand;
 	ZipDirectory *zipd;
 	int j;
+#if defined(HAVE_MMAP) && defined(HAVE_UNALIGNEDACCESS)
+	long start;
+#endif
 
 	/* Look for the class */
 CDBG(	printf("Scanning for element %s\n", cname);		)
 
-	/* One into the jar at once */
-	lockMutex(&jarlock);
-
 	for (i = 0; classpath[i].path != 0; i++) {
 		hand.type = classpath[i].type;
 		switch (classpath[i].type) {
 		case CP_ZIPFILE:
-ZDBG(			printf("Opening zip file %s for %s\n", classpath[i].path, cname); )
-			if (classpath[i].u.zipf.central_directory == 0) {
-				classpath[i].u.zipf.fd = open(classpath[i].path, O_RDONLY|O_BINARY);
-				if (classpath[i].u.zipf.fd < 0) {
-					break;
-				}
-				if (read_zip_archive(&classpath[i].u.zipf) != 0) {
-					close(classpath[i].u.zipf.fd);
-					break;
-				}
-				close(classpath[i].u.zipf.fd);
+			if (classpath[i].u.zipf.index == 0
+			    && openZipArchive(i) != 0) {
+				break;
 			}
 
-			zipd = (ZipDirectory*)classpath[i].u.zipf.central_directory;
-			for (j = 0; j < classpath[i].u.zipf.count; j++, zipd = ZIPDIR_NEXT(zipd)) {
+			zipd = find_zip_entry(&classpath[i].u.zipf, cname);
+			if (zipd == 0) {
+				break;
+			}
 
-ZDBG(				printf ("%d: size:%d, name(#%d)%s, offset:%d\n", i, zipd->size, zipd->filename_length, ZIPDIR_FILENAME (zipd), zipd->filestart);  )
-				if (cname[0] == ZIPDIR_FILENAME(zipd)[0] && strcmp(cname, ZIPDIR_FILENAME(zipd)) == 0) {
+ZDBG(			printf ("%d: size:%d, name(#%d)%s, offset:%d\n", i, zipd->size, zipd->filename_length, ZIPDIR_FILENAME (zipd), zipd->localstart);  )
 
-ZDBG(					printf("FOUND!!\n");		)
+			/* If size is negative then this
+			 * is compressed with a method we can't handle !!
+			 */
+			if (zipd->size == -1) {
+				throwException(IOException("cannot handle compressed entry in JAR/ZIP file"));
+			}
 
-					/* If size is negative then this
-					 * is compressed !!
-					 */
-					if (zipd->size == -1) {
-						throwException(IOException("cannot handle compressed entry in JAR/ZIP file"));
-					}
+			if (zipd->compressed_size != 0) {
+				hand.size = zipd->size;
+				hand.base = gc_malloc_fixed(hand.size);
+				hand.buf = hand.base;
+				if (inflateZipEntry(i, zipd, (char*)hand.buf) != 0) {
+					gc_free_fixed(hand.base);
+					throwException(IOException("failed to inflate JAR data"));
+				}
+				goto okay;
+			}
 
 #if defined(HAVE_MMAP) && defined(HAVE_UNALIGNEDACCESS)
-					hand.size = zipd->size;
-					hand.base = NULL;
-					hand.buf = classpath[i].u.zipf.mmap_base + zipd->filestart;
-					goto okay;
+			start = zip_entry_start(&classpath[i].u.zipf, zipd, -1);
+			if (start < 0) {
+				break;
+			}
+			hand.size = zipd->size;
+			hand.base = NULL;
+			hand.buf = classpath[i].u.zipf.mmap_base + start;
+			goto okay;
 #else
-					fp = open(classpath[i].path, O_RDONLY|O_BINARY);
-					lseek(fp, zipd->filestart, SEEK_SET);
-					hand.size = zipd->size;
-					goto found;
-#endif
-				}
+			fp = open(classpath[i].path, O_RDONLY|O_BINARY);
+			if (fp < 0) {
+				break;
 			}
-			break;
+			if (lseek(fp, zip_entry_start(&classpath[i].u.zipf, zipd, fp), SEEK_SET) < 0) {
+				close(fp);
+				break;
+			}
+			hand.size = zipd->size;
+			goto found;
+#endif
 
 		case CP_DIR:
 			strcpy(buf, classpath[i].path);
@@ -211,13 +245,26 @@ FDBG(			printf("Opening java file %s for %s\n", buf, cname); )
 			close(fp);
 			goto okay;
 
+		case CP_ARCHIVE:
+			if (classpath[i].u.arch.base == 0
+			    && openArchive(i) != 0) {
+				break;
+			}
+			if (findInClassArchive(&classpath[i].u.arch, cname, &hand) == 0) {
+				break;
+			}
+			goto okay;
+
 		case CP_SOFILE:
+			lockMutex(&jarlock);
 			if (classpath[i].u.sof.loaded == 0) {
 				if (loadNativeLibrary(classpath[i].path) < 0) {
+					unlockMutex(&jarlock);
 					break;
 				}
 				classpath[i].u.sof.loaded = 1;
 			}
+			unlockMutex(&jarlock);
 			strcat(buf, CLASSSYMPREFIX);
 			strcat(buf, cname);
 			hand.base = loadNativeLibrarySym(buf);
@@ -235,9 +282,162 @@ FDBG(			printf("Opening java file %s for %s\n", buf, cname); )
 	hand.type = CP_INVALID;
 
 	okay:;
+	return (hand);
+}
+
+/*
+ * Open and index the I'th zip file in the class path.  Returns
+ * non-zero if it can't be read, in which case it is ignored from
+ * then on.
+ */
+static
+int
+openZipArchive(int i)
+{
+	ZipFile* zipf = &classpath[i].u.zipf;
+	int r = 0;
+
+	lockMutex(&jarlock);
+
+	/* Somebody else may have opened it while we waited */
+	if (zipf->index == 0 && classpath[i].type == CP_ZIPFILE) {
+ZDBG(		printf("Opening zip file %s\n", classpath[i].path); )
+		zipf->fd = open(classpath[i].path, O_RDONLY|O_BINARY);
+		if (zipf->fd < 0) {
+			r = -1;
+		}
+		else {
+			r = read_zip_archive(zipf);
+			close(zipf->fd);
+		}
+		if (r != 0) {
+			classpath[i].type = CP_INVALID;
+		}
+	}
+	else if (zipf->index == 0) {
+		r = -1;
+	}
+
 	unlockMutex(&jarlock);
 
-	return (hand);
+	return (r);
+}
+
+/*
+ * Map the I'th class archive in the class path.  Returns non-zero if
+ * it can't be read, in which case it is ignored from then on.
+ */
+static
+int
+openArchive(int i)
+{
+	int r = 0;
+
+	lockMutex(&jarlock);
+
+	/* Somebody else may have opened it while we waited */
+	if (classpath[i].u.arch.base == 0 && classpath[i].type == CP_ARCHIVE) {
+		r = openClassArchive(&classpath[i].u.arch, classpath[i].path);
+		if (r != 0) {
+			classpath[i].type = CP_INVALID;
+		}
+	}
+	else if (classpath[i].u.arch.base == 0) {
+		r = -1;
+	}
+
+	unlockMutex(&jarlock);
+
+	return (r);
+}
+
+/*
+ * Inflate the deflated entry ZIPD of the I'th zip file in the class
+ * path into OUT.  Small entries are cached, so that resources which
+ * are read again and again need not be inflated each time.
+ */
+static
+int
+inflateZipEntry(int i, ZipDirectory* zipd, char* out)
+{
+	char* in;
+	char* data;
+	int c;
+	int r;
+#if defined(HAVE_MMAP) && defined(HAVE_UNALIGNEDACCESS)
+	long start;
+#endif
+
+	lockMutex(&jarlock);
+	for (c = 0; c < ZIPCACHESIZE; c++) {
+		if (classpath[i].cache[c].zipd == zipd) {
+			memcpy(out, classpath[i].cache[c].data, zipd->size);
+			unlockMutex(&jarlock);
+			return (0);
+		}
+	}
+	unlockMutex(&jarlock);
+
+#if defined(HAVE_MMAP) && defined(HAVE_UNALIGNEDACCESS)
+	start = zip_entry_start(&classpath[i].u.zipf, zipd, -1);
+	if (start < 0) {
+		return (-1);
+	}
+	in = classpath[i].u.zipf.mmap_base + start;
+	r = inflate_zip_entry(in, zipd->compressed_size, out, zipd->size);
+#else
+	{
+		int fp;
+		int n;
+
+		fp = open(classpath[i].path, O_RDONLY|O_BINARY);
+		if (fp < 0) {
+			return (-1);
+		}
+		if (lseek(fp, zip_entry_start(&classpath[i].u.zipf, zipd, fp), SEEK_SET) < 0) {
+			close(fp);
+			return (-1);
+		}
+
+		in = gc_malloc_fixed(zipd->compressed_size);
+		for (n = 0; n < zipd->compressed_size; ) {
+			r = read(fp, in + n, zipd->compressed_size - n);
+			if (r > 0) {
+				n += r;
+			}
+			else if (r == 0 || !(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+				break;
+			}
+		}
+		close(fp);
+
+		r = -1;
+		if (n == zipd->compressed_size) {
+			r = inflate_zip_entry(in, zipd->compressed_size, out, zipd->size);
+		}
+		gc_free_fixed(in);
+	}
+#endif
+	if (r != 0 || zipd->size > ZIPCACHEMAX) {
+		return (r);
+	}
+
+	/* Replace the oldest entry in the cache */
+	data = gc_malloc_fixed(zipd->size);
+	memcpy(data, out, zipd->size);
+
+	lockMutex(&jarlock);
+	c = classpath[i].cachenext;
+	classpath[i].cachenext = (c + 1) % ZIPCACHESIZE;
+	in = classpath[i].cache[c].data;
+	classpath[i].cache[c].zipd = zipd;
+	classpath[i].cache[c].data = data;
+	unlockMutex(&jarlock);
+
+	if (in != 0) {
+		gc_free_fixed(in);
+	}
+	return (0);
 }
 
 /*
@@ -282,7 +482,7 @@ getClasspathType(char* path)
 {
 	int h;
 	int c;
-	char buf[2];
+	unsigned char buf[4];
 	struct stat sbuf;
 
 	if (stat(path, &sbuf) < 0) {
@@ -300,13 +500,16 @@ getClasspathType(char* path)
 
 	c = read(h, buf, sizeof(buf));
 	close(h);
-	if (c != sizeof(buf)) {
+	if (c < 2) {
 		return (CP_INVALID);
 	}
 
 	if (IS_ZIP(buf)) {
 		return (CP_ZIPFILE);
 	}
+	if (c == sizeof(buf) && isClassArchive(buf)) {
+		return (CP_ARCHIVE);
+	}
 
 	/* We should work out some way to check this ... */
 	return (CP_SOFILE);
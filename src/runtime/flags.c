@@ -71,6 +71,18 @@ int flag_exception = 0;
 //
 int flag_tr_time = 0;
 
+//
+// Specify the file to which the JIT event log is written
+//
+char *flag_jit_log = NULL;
+
+//
+// Specify the file to which the names of loaded classes are written,
+// and the file of names of classes to load ahead of use
+//
+char *flag_record_classes = NULL;
+char *flag_prefetch_classes = NULL;
+
 //
 // Specify whether to use old make_regsters_consistent()
 //
@@ -105,8 +117,21 @@ int The_Use_Loopopt_Option = 1; // command line option
 int flag_loopopt_num = 0;
 int flag_looppeeling = 1;   // default: no loop peeling
 
+// turn on/off scalar replacement of non-escaping objects
+int flag_no_escape = 0;
+
+// turn on/off inline allocation of small objects
+int flag_no_inline_alloc = 0;
+
 // turn on/off the backward sweep
 int flag_no_backward_sweep = 0;
+int The_Use_Backward_Sweep_Option = 1; // command line option
+
+// use the full register allocator for the initial translations
+int flag_no_light_regalloc = 0;
+
+// turn on/off inline translation of some java.lang.Math methods
+int flag_no_intrinsics = 0;
 
 // turn on/off the simple live analysis
 int flag_no_live_analysis = 0;
@@ -136,6 +161,21 @@ int The_Final_Translation_Flag;
 int The_Need_Retranslation_Flag; 
 
 int The_Max_Retranslation_Threshold = 50;
+
+/* Flag for on-stack replacement of lightly translated loops. */
+int flag_osr = 1;
+
+/* Number of loop iterations before on-stack replacement. */
+int The_OSR_Threshold = 10000;
+
+/* Flag for deoptimization of code which speculatively inlined a method
+   that gets overridden.  Without it, only tiny methods are inlined
+   speculatively, since their guards stay in the code forever. */
+int flag_deopt = 1;
+
+/* Flag for basic block profiling in light translations, which guides
+   inlining and code placement of their retranslations. */
+int flag_block_profile = 1;
 #endif
 
 #ifdef TYPE_ANALYSIS
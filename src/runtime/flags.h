@@ -23,6 +23,9 @@ extern int flag_code;
 extern int flag_exception;
 extern int flag_called_method;
 extern int flag_tr_time;
+extern char *flag_jit_log;
+extern char *flag_record_classes;
+extern char *flag_prefetch_classes;
 extern int flag_old_join;
 extern int flag_time;
 extern int flag_call_stat;
@@ -37,7 +40,10 @@ extern int flag_no_regionopt_num; // region optimization num
 extern int flag_regionopt_num; // region optimization num
 extern int flag_no_dce; // dead code elimination
 extern int flag_dce_num; 
-extern int flag_no_backward_sweep;
+extern int flag_no_backward_sweep; // (can be changed any time)
+extern int The_Use_Backward_Sweep_Option; // command line option
+extern int flag_no_light_regalloc; // full allocation on initial translation
+extern int flag_no_intrinsics; // inline java.lang.Math methods
 extern int flag_no_live_analysis;
 extern int flag_no_copy_coalescing;
 
@@ -45,6 +51,8 @@ extern int flag_no_loopopt; // LICM, register promotion
 extern int The_Use_Loopopt_Option; // command line option
 extern int flag_loopopt_num;
 extern int flag_looppeeling;
+extern int flag_no_escape; // scalar replacement of objects
+extern int flag_no_inline_alloc; // bump-pointer allocation in translated code
 
 
 
@@ -64,6 +72,16 @@ extern int flag_adapt;
 extern int The_Retranslation_Threshold;
 extern int The_Max_Retranslation_Threshold;
 
+/* Flag for on-stack replacement of lightly translated loops. */
+extern int flag_osr;
+extern int The_OSR_Threshold;
+
+/* Flag for deoptimization of speculatively inlined code. */
+extern int flag_deopt;
+
+/* Flag for basic block profiling in light translations. */
+extern int flag_block_profile;
+
 // to control retranslation
 extern int The_Final_Translation_Flag; 
 extern int The_Need_Retranslation_Flag; 
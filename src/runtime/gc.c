@@ -996,8 +996,9 @@ struct small_chunk_table {
     } table[SMALL_CHUNKS_LIST_INDEX_SIZE];
 };
 
-/* The range of the current free area. */
-static gc_head *small_cursor, *small_bound;
+/* The range of the current free area.  Translated code allocates
+   from it inline, so it is exported (see gc.h). */
+struct gc_small_lab gc_small_lab;
 
 /* The free chunk list. */
 static struct gc_small_chunk *small_chunks;
@@ -1075,17 +1076,17 @@ gc_malloc_small (size_t size)
     LOCK();
 
     /* Allocate memory. */
-    tmp = small_cursor;
-    small_cursor = (gc_head*)((char*)tmp + size);
+    tmp = gc_small_lab.cursor;
+    gc_small_lab.cursor = (gc_head*)((char*)tmp + size);
 
     /* Check if allocation is valid. */
-    if (small_cursor > small_bound) {
+    if (gc_small_lab.cursor > gc_small_lab.bound) {
 	/* Use slower allocator instead. */
-	small_cursor = (gc_head*)((char*)small_cursor - size);
+	gc_small_lab.cursor = (gc_head*)((char*)gc_small_lab.cursor - size);
 	tmp = slow_small_allocate(size);
     }
 
-    memset(tmp, 0, size);
+    /* The free area is already cleared by get_small_chunk(). */
     *tmp = size;	/* Set object header. */
 
     UNLOCK();
@@ -1246,11 +1247,16 @@ get_small_chunk (size_t size)
     } else
 	return NULL;
 
-    small_cursor = (gc_head*)((char*)cursor + size);
-    small_bound = bound;
+    /* Clear the whole free area at once, so that neither
+       gc_malloc_small() nor the inline allocation code in translated
+       methods has to clear each object. */
+    memset(cursor, 0, (char*)bound - (char*)cursor);
+
+    gc_small_lab.cursor = (gc_head*)((char*)cursor + size);
+    gc_small_lab.bound = bound;
 
     /* Update the allocation statistics. */
-    gc_stats.small_alloc += (char*)small_bound - (char*)cursor;
+    gc_stats.small_alloc += (char*)gc_small_lab.bound - (char*)cursor;
 
     return cursor;
 }
@@ -1270,11 +1276,13 @@ slow_small_allocate (size_t size)
     assert(size % MEMALIGN == 0);
 
     /* Set up the current free area so that garbage collection works. */
-    if (small_cursor < small_bound) {
-	*small_cursor = ((char*)small_bound - (char*)small_cursor) | FREE_BIT;
+    if (gc_small_lab.cursor < gc_small_lab.bound) {
+	*gc_small_lab.cursor = ((char*)gc_small_lab.bound
+				- (char*)gc_small_lab.cursor) | FREE_BIT;
 
 	/* Update allocation statistics. */
-	gc_stats.small_alloc -= (char*)small_bound - (char*)small_cursor;
+	gc_stats.small_alloc -=
+	    (char*)gc_small_lab.bound - (char*)gc_small_lab.cursor;
     }
 
     p = get_small_chunk(size);
@@ -1296,7 +1304,7 @@ slow_small_allocate (size_t size)
 	} else {
 	    /* Clear cursor and bound pointers so that we can later
 	       find out if another thread reset them. */
-	    small_cursor = small_bound = NULL;
+	    gc_small_lab.cursor = gc_small_lab.bound = NULL;
 
 	    /* Try garbage collection. */
 	    gc_invoke(1);
@@ -1305,14 +1313,14 @@ slow_small_allocate (size_t size)
 	       above call was made, it is possible that the cursor and
 	       bound pointers are already set.  FIXME: unnecessary
 	       when GC_LOCK() actually works as intended */
-	    if (small_cursor < small_bound) {
+	    if (gc_small_lab.cursor < gc_small_lab.bound) {
 		/* Slack remains.  Reset free area header. */
-		*small_cursor =
-		    ((char*)small_bound - (char*)small_cursor) | FREE_BIT;
+		*gc_small_lab.cursor = ((char*)gc_small_lab.bound
+				    - (char*)gc_small_lab.cursor) | FREE_BIT;
 
 		/* Update allocation statistics. */
 		gc_stats.small_alloc -=
-		    (char*)small_bound - (char*)small_cursor;
+		    (char*)gc_small_lab.bound - (char*)gc_small_lab.cursor;
 	    }
 
 	    p = get_small_chunk(size);
@@ -1347,14 +1355,16 @@ prepare_gc_small (void)
 
     /* Set up the header in the current free area so that sweeping
        during garbage collection works. */
-    if (small_cursor < small_bound) {
-	*small_cursor = ((char*)small_bound - (char*)small_cursor) | FREE_BIT;
+    if (gc_small_lab.cursor < gc_small_lab.bound) {
+	*gc_small_lab.cursor = ((char*)gc_small_lab.bound
+				- (char*)gc_small_lab.cursor) | FREE_BIT;
 
 	/* Update allocation statistics. */
-	gc_stats.small_alloc -= (char*)small_bound - (char*)small_cursor;
+	gc_stats.small_alloc -=
+	    (char*)gc_small_lab.bound - (char*)gc_small_lab.cursor;
     }
 
-    small_cursor = small_bound = NULL;
+    gc_small_lab.cursor = gc_small_lab.bound = NULL;
 
     /* Mark used blocks in the block usage tables.
        This is used for supporting conservative marking. */
@@ -98,6 +98,17 @@ extern int gc_finalize_on_exit;
 extern void gc_init (void);		/* Initialize the garbage collector. */
 extern void gc_fixed_init (void);	/* Initialize the memory manager. */
 
+/* The linear allocation buffer of the small object area.  Memory
+   between CURSOR and BOUND is free and already cleared, so that an
+   object of SIZE bytes (including the header) can be allocated by
+   bumping CURSOR as long as it does not pass BOUND.  Translated code
+   does this inline and calls gc_malloc_small() only on overflow.
+   It is shared by all threads, so it must only be touched with
+   blockInts raised, as gc_malloc_small() does with LOCK(). */
+extern struct gc_small_lab {
+    gc_head *cursor, *bound;
+} gc_small_lab;
+
 /* Allocate small object directly from heap.
    SIZE includes the header overhead, and must be aligned. */
 extern void* gc_malloc_small (size_t size);
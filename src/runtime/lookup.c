@@ -104,23 +104,20 @@ DBG(	printf("getMethodSignatureClass(%s,%s,%s)\n",
 
     /* Find method */
     for (cptr = class; cptr != 0; cptr = cptr->superclass) {
-        nmethods = CLASS_NMETHODS(cptr);
-        for (mptr = CLASS_METHODS(cptr); --nmethods >= 0; ++mptr) {
-            if (equalUtf8Consts (name, mptr->name)
-                && equalUtf8Consts (sig, mptr->signature)) {
-                /* Found method - but if it's abstract, point
-                 * it at some error code.
-                 */
-                if ((mptr->accflags & ACC_ABSTRACT) != 0) {
-                    METHOD_NATIVECODE(mptr) =
-                        (void*)throwAbstractMethodError;
-                    mptr->accflags |= ACC_NATIVE;
-                }
-
-		checkAccess(meth->class, cptr, mptr->accflags);
-
-                return mptr;
+        mptr = findMethodLocal(cptr, name, sig);
+        if (mptr != NULL) {
+            /* Found method - but if it's abstract, point
+             * it at some error code.
+             */
+            if ((mptr->accflags & ACC_ABSTRACT) != 0) {
+                METHOD_NATIVECODE(mptr) =
+                    (void*)throwAbstractMethodError;
+                mptr->accflags |= ACC_NATIVE;
             }
+
+            checkAccess(meth->class, cptr, mptr->accflags);
+
+            return mptr;
         }
     }       
 
@@ -136,6 +133,8 @@ DBG(	printf("getMethodSignatureClass(%s,%s,%s)\n",
         dtable->method[nmethods] = class->dtable->method[nmethods];
     }
 
+    dtable->display = class->dtable->display;
+
     class->msize++;
     class->dtable = dtable;
     GC_WRITE(class, dtable);
@@ -275,25 +274,18 @@ Method*
 find_clinit( Hjava_lang_Class* class )
 {
     Method*   method;
-    int       n = CLASS_NMETHODS( class );
 
-    for ( method = CLASS_METHODS( class );
-          --n >= 0;
-          method++ ) {
-        if ( equalUtf8Consts( init_name, method->name )
-             && equalUtf8Consts( void_signature, method->signature ) ) {
+    method = findMethodLocal( class, init_name, void_signature );
+    if ( method != NULL ) {
 #if !defined(INTERPRETER)
 #ifdef CUSTOMIZATION
-            SMS_AddSM( method->sms, SM_new( GeneralType, method ) );
+        SMS_AddSM( method->sms, SM_new( GeneralType, method ) );
 #endif
-            kaffe_translate( method ); 
+        kaffe_translate( method ); 
 #endif /* not INTERPRETER */
-
-            return method;
-        }
     }
 
-    return NULL;
+    return method;
 }
 
 /*
@@ -362,18 +354,111 @@ checkAccess(Hjava_lang_Class* a, Hjava_lang_Class* b, accessFlags flags)
 #endif /* TRANSLATOR */
 }
 
+/*
+ * Methods and fields are hashed by their names and signatures.
+ * Interned Utf8Consts are hashed by address.
+ */
+#if INTERN_UTF8CONSTS
+#define	UTF8HASH(U)		((uint32)(uintp)(U) >> 3)
+#else
+#define	UTF8HASH(U)		((uint32)(U)->hash)
+#endif
+#define	METHODHASH(N, S)	(UTF8HASH(N) * 31 + UTF8HASH(S))
+#define	FIELDHASH(N)		UTF8HASH(N)
+
+/* The bit of a method name in the filter of a class, which has the
+ * bits of all the method names of the class and its superclasses. */
+#define	NAMEBIT(N)		(1 << (UTF8HASH(N) & 31))
+
+static
+memberTable*
+newMemberTable(int n)
+{
+    memberTable* table;
+    int size;
+
+    /* Keep the table at most half full */
+    for (size = 2; size < 2 * n; size <<= 1)
+	;
+    table = gc_malloc_fixed(sizeof(memberTable) + (size - 1) * sizeof(void*));
+    table->size = size;
+    return (table);
+}
+
+static
+void
+addMember(memberTable* table, uint32 hash, void* member)
+{
+    int i;
+
+    for (i = hash & (table->size - 1);
+	 table->slot[i] != 0;
+	 i = (i + 1) & (table->size - 1))
+	;
+    table->slot[i] = member;
+}
+
+/*
+ * Build the method and field tables of a class when it is linked.
+ */
+void
+buildMemberTables(Hjava_lang_Class* class)
+{
+    memberTable* table;
+    Method* mptr;
+    Field* fptr;
+    uint32 names;
+    int n;
+
+    names = 0;
+    table = newMemberTable(CLASS_NMETHODS(class));
+    for (n = CLASS_NMETHODS(class), mptr = CLASS_METHODS(class); --n >= 0; mptr++) {
+	addMember(table, METHODHASH(mptr->name, mptr->signature), mptr);
+	names |= NAMEBIT(mptr->name);
+    }
+    if (class->superclass != 0) {
+	/* If the superclass has no table yet, don't filter anything */
+	names |= class->superclass->methodTable != 0
+		 ? class->superclass->methodNames : ~0;
+    }
+    class->methodNames = names;
+    class->methodTable = table;
+
+    table = newMemberTable(CLASS_NFIELDS(class));
+    for (n = CLASS_NFIELDS(class), fptr = CLASS_FIELDS(class); --n >= 0; fptr++) {
+	addMember(table, FIELDHASH(fptr->name), fptr);
+    }
+    class->fieldTable = table;
+}
+
 /*
  * Lookup a method (and translate) in the specified class.
  */
 Method*
 findMethodLocal(Hjava_lang_Class* class, Utf8Const* name, Utf8Const* signature)
 {
+    memberTable* table;
     Method* mptr;
     int n;
+    int i;
+
     /*
-     * Lookup method - this could be alot more efficient but never mind.
-     * Also there is no attempt to honour PUBLIC, PRIVATE, etc.
+     * There is no attempt to honour PUBLIC, PRIVATE, etc.
      */
+    table = class->methodTable;
+    if (table != 0) {
+	for (i = METHODHASH(name, signature) & (table->size - 1);
+	     (mptr = table->slot[i]) != 0;
+	     i = (i + 1) & (table->size - 1)) {
+	    if (equalUtf8Consts (name, mptr->name)
+		&& equalUtf8Consts (signature, mptr->signature)) {
+		return (mptr);
+	    }
+	}
+	return (NULL);
+    }
+
+    /* Not linked yet */
     n = CLASS_NMETHODS(class);
     for (mptr = CLASS_METHODS(class); --n >= 0; ++mptr) {
         if (equalUtf8Consts (name, mptr->name)
@@ -399,11 +484,16 @@ findMethod(Hjava_lang_Class* class, Utf8Const* name, Utf8Const* signature)
     }
 
     /*
-     * Lookup method - this could be alot more efficient but never mind.
-     * Also there is no attempt to honour PUBLIC, PRIVATE, etc.
+     * Lookup method - there is no attempt to honour PUBLIC, PRIVATE, etc.
      */
     for (; class != 0; class = class->superclass) {
-        Method* mptr = findMethodLocal(class, name, signature);
+        Method* mptr;
+
+        /* Not in this class or its superclasses */
+        if (class->methodTable != 0 && !(class->methodNames & NAMEBIT(name))) {
+            return (0);
+        }
+        mptr = findMethodLocal(class, name, signature);
         if (mptr != NULL) {
             return mptr;
         }
@@ -411,6 +501,49 @@ findMethod(Hjava_lang_Class* class, Utf8Const* name, Utf8Const* signature)
     return (0);
 }
 
+/*
+ * Lookup a field in the specified class.
+ */
+Field*
+findFieldLocal(Hjava_lang_Class* class, Utf8Const* name, bool isStatic)
+{
+    memberTable* table;
+    Field* fptr;
+    int n;
+    int i;
+
+    table = class->fieldTable;
+    if (table != 0) {
+	for (i = FIELDHASH(name) & (table->size - 1);
+	     (fptr = table->slot[i]) != 0;
+	     i = (i + 1) & (table->size - 1)) {
+	    /* Static fields come first */
+	    if (equalUtf8Consts (name, fptr->name)
+		&& (isStatic ? fptr < CLASS_IFIELDS(class)
+			     : fptr >= CLASS_IFIELDS(class))) {
+		return (fptr);
+	    }
+	}
+	return (NULL);
+    }
+
+    /* Not linked yet */
+    if (isStatic) {
+        fptr = CLASS_SFIELDS(class);
+        n = CLASS_NSFIELDS(class);
+    }
+    else {
+        fptr = CLASS_IFIELDS(class);
+        n = CLASS_NIFIELDS(class);
+    }
+    for (; --n >= 0; fptr++) {
+        if (equalUtf8Consts (name, fptr->name)) {
+            return (fptr);
+        }
+    }
+    return (NULL);
+}
+
 #if defined(TRANSLATOR)
 /*
  * Find exception in method.
@@ -15,6 +15,13 @@
 
 struct _dispatchTable;
 
+/* An open addressed hash table of the methods or fields of a class,
+   keyed by name and signature, or by name for fields. */
+typedef struct _memberTable {
+	int			size;	/* A power of two */
+	void*			slot[1];
+} memberTable;
+
 typedef struct _callInfo {
 	short			in;
 	short			out;
@@ -38,6 +45,8 @@ Method* find_clinit(Hjava_lang_Class* class);
 
 Method* findMethod(Hjava_lang_Class*, Utf8Const*, Utf8Const*);
 Method* findMethodLocal(Hjava_lang_Class*, Utf8Const*, Utf8Const*);
+Field*	findFieldLocal(Hjava_lang_Class*, Utf8Const*, bool);
+void	buildMemberTables(Hjava_lang_Class*);
 void	findExceptionInMethod(uintp, Hjava_lang_Class*, exceptionInfo*);
 bool	findExceptionBlockInMethod(uintp, Hjava_lang_Class*, Method*, exceptionInfo*);
 
@@ -38,6 +38,7 @@
 #include "exception.h"
 #include "locks.h"
 #include "soft.h"
+#include "class_inclusion_test.h"
 #include "external.h"
 #include "thread.h"
 #include "baseClasses.h"
@@ -308,6 +309,11 @@ instanceof_class(Hjava_lang_Class* c, Hjava_lang_Class* oc)
 		return (0);
 	}
 
+	/* Linked classes are known to the class inclusion test. */
+	if (Class_GetTypeRep(oc)->supers != 0) {
+		return (CIT_is_subclass(oc, c));
+	}
+
 	if (instanceof_class(c, oc->superclass)) {
 		return (1);
 	}
@@ -29,6 +29,9 @@
 #ifdef TRANSLATOR
 #include "method_inlining.h"
 #include "exception_info.h"
+#ifdef METHOD_COUNT
+#include "code_sweeper.h"
+#endif
 #endif
 
 /* Used for filling class contexts. */
@@ -56,6 +59,10 @@ struct stack_trace {
     jword *trace;
 };
 
+/* Raw stack traces store the return PC of a frame with this bit set,
+   since Method pointers and PCs are both word aligned. */
+#define RAW_PC_TAG	1
+
 /* When walking stacks, functions of this type are given as arguments
    to walk_stack().  This accepts the method pointer executing the
    current stack frame, the bytecode PC, and an extra function
@@ -75,6 +82,9 @@ static int find_class_loader (Method*, int, void*);
 static int find_class (Method*, int, void*);
 static int count_valid_frame (Method*, int, void*);
 static int fill_in_trace (Method*, int, void*);
+static int store_frame (Method*, int, void*);
+static void capture_stack (exceptionFrame*, struct stack_trace*);
+static void resolve_raw_trace (jword*, guard, void*);
 
 /* FIXME: the functions here should be moved elsewhere */
 #ifdef STACKTRACE_ALIEN
@@ -88,6 +98,7 @@ extern exceptionFrame* kaffe_walk_stack (MethodInstance*, exceptionFrame*,
 					 guard, void*);
 extern exceptionFrame* MI_walk_stack (MethodInstance*, exceptionFrame*,
 				      guard, void*);
+static int MI_walk_pc (MethodInstance*, uintp, guard, void*);
 #endif /* TRANSLATOR */
 
 #ifdef INTERPRETER
@@ -164,6 +175,26 @@ kaffe_walk_stack (MethodInstance *instance, exceptionFrame *base,
 exceptionFrame*
 MI_walk_stack (MethodInstance *instance, exceptionFrame *base,
 	       guard func, void *info)
+{
+    if (MI_walk_pc(instance, PCFRAME(base), func, info) != 0)
+	return NULL;
+
+    return (exceptionFrame*)base->retbp;
+}
+
+/* Name        : MI_walk_pc
+   Description : Process the methods active at a PC of translated code.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
+   Pre-condition:
+     INSTANCE is the method instance containing PC.
+     FUNC is the function which determines when to stop.
+     INFO is an argument to FUNC.
+   Post-condition:
+     Non-zero is returned if FUNC asked to stop.
+   Notes:
+     The innermost inlined method comes first. */
+static int
+MI_walk_pc (MethodInstance *instance, uintp pc, guard func, void *info)
 {
     ExceptionInfoTable *eitable;
 
@@ -172,7 +203,7 @@ MI_walk_stack (MethodInstance *instance, exceptionFrame *base,
     if (eitable != NULL) {
 	ExceptionInfo *einfo;
 
-	einfo = EIT_find(eitable, PCFRAME(base));
+	einfo = EIT_find(eitable, pc);
 
 	if (EIT_GetNativePC(einfo) != 0) {
 	    /* Traverse each inlined method included in the current
@@ -185,7 +216,7 @@ MI_walk_stack (MethodInstance *instance, exceptionFrame *base,
 
 	    do {
 		if (func(MI_GetMethod(member), bpc, info))
-		    return NULL;
+		    return 1;
 
 		bpc = MI_GetRetBPC(member);
 		member = MI_GetCaller(member);
@@ -193,7 +224,7 @@ MI_walk_stack (MethodInstance *instance, exceptionFrame *base,
 	}
     }
 
-    return (exceptionFrame*)base->retbp;
+    return 0;
 }
 #endif /* TRANSLATOR */
 
@@ -279,32 +310,27 @@ classDepth (char *name)
 
    Post-condition:
      The return value is a value that should never be used except in
-     printStackTrace0().  It is an array (*not* a Java array!) which
-     stores the the method pointer and the bytecode PC (if any) pair,
-     and starts with the number of entries in the trace.  For example,
-     the stack trace
-
-       method1 (BPC: 10)
-       method2 (BPC: 12)
-
-     would be stored as [ 2, &method1, 10, &method2, 12 ] (or
-     something like that).  BPCs for compiled methods are -1.  Method
-     pointers for native code are NULL.
-
-     This is done to improve the speed of generating exceptions, since
-     this should be much more faster than filling in a array of
-     strings.  This is justified since a lot of exceptions are usually
-     discarded without printing their stack trace.
+     resolveStackTrace().  It is an array (*not* a Java array!) which
+     starts with the negated number of entries and the reclaim count
+     of the code sweeper, followed by the return PC of each frame
+     tagged with RAW_PC_TAG.  Interpreter frames can't be found again
+     from their PCs, so they are stored as the method pointer and
+     bytecode PC pair.  For example, [ -4, 0, pc1|1, &method2, 12,
+     pc3|1 ] (or something like that).
+
+     Finding the methods of the frames, which includes looking up
+     exception information tables for inlined methods, is left to
+     resolveStackTrace().  This is justified since a lot of exceptions
+     are usually discarded without printing their stack trace.
 
    Notes:
      Never, *ever*, should anything use the result returned from this
-     function, with the sole exception of printStackTrace0() and its
-     closely associated functions. */
+     function, with the sole exception of resolveStackTrace(). */
 Hjava_lang_Object*
 buildStackTrace (exceptionFrame *base)
 {
-    int depth;
-    struct stack_trace trace;
+    struct stack_trace raw;
+    int size;
 
     asm volatile ("ta 3"); /* Spill registers. */
 
@@ -315,24 +341,181 @@ buildStackTrace (exceptionFrame *base)
 	base = (exceptionFrame*)frame->retbp;
     }
 
-    /* Count stack depth. */
-    depth = 0;
-    walk_stack(base, count_valid_frame, &depth);
+    /* Count stack frames. */
+    raw.size = 0;
+    raw.trace = NULL;
+    capture_stack(base, &raw);
+    size = raw.size;
 
     /* The memory for the stack trace is allocated as memory not to be
        walked since it does not refer to memory managed by the garbage
        collector. */
+    raw.trace = gc_malloc((size+3) * sizeof(jword), &gc_no_walk);
+    ((Hjava_lang_Object*)raw.trace)->dtable = &trace_dtable;
+    raw.trace[1] = (jword)-size;
+#if defined(TRANSLATOR) && defined(METHOD_COUNT)
+    raw.trace[2] = (jword)CSW_get_reclaim_count();
+#endif
+    raw.size = 0;
+
+    /* Fill in stack trace. */
+    capture_stack(base, &raw);
+
+    return (Hjava_lang_Object*)raw.trace;
+}
+
+/* Name        : resolveStackTrace
+   Description : Find the methods of a stack trace.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
+   Pre-condition:
+     OBJ was returned by buildStackTrace() or by this function, or is
+     NULL.
+
+   Post-condition:
+     The return value is an array (*not* a Java array!) which stores
+     the method pointer and the bytecode PC (if any) pair, and starts
+     with the number of entries in the trace.  For example, the stack
+     trace
+
+       method1 (BPC: 10)
+       method2 (BPC: 12)
+
+     would be stored as [ 2, &method1, 10, &method2, 12 ] (or
+     something like that).  BPCs for compiled methods are -1.  Method
+     pointers which could not be filled in are NULL.
+
+   Notes:
+     Frames of code reclaimed after the trace was built are found
+     from what the code sweeper kept of them, since their PCs may now
+     be in other code.  The result should replace OBJ, so that it is
+     resolved only once. */
+Hjava_lang_Object*
+resolveStackTrace (Hjava_lang_Object *obj)
+{
+    jword *raw;
+    int depth;
+    struct stack_trace trace;
+
+    raw = (jword*)obj;
+    if (raw == NULL || (int)raw[1] >= 0)
+	return obj;
+
+    /* Count stack depth. */
+    depth = 0;
+    resolve_raw_trace(raw, count_valid_frame, &depth);
+
     trace.trace = gc_malloc((2*depth+2) * sizeof(jword), &gc_no_walk);
     ((Hjava_lang_Object*)trace.trace)->dtable = &trace_dtable;
     trace.trace[1] = (jword)depth;
     trace.size = 0;
 
     /* Fill in stack trace. */
-    walk_stack(base, fill_in_trace, &trace);
+    resolve_raw_trace(raw, fill_in_trace, &trace);
 
     return (Hjava_lang_Object*)trace.trace;
 }
-
+
+/* Name        : capture_stack
+   Description : Store the raw frames of the stack.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
+   Pre-condition:
+     BASE is the stack frame where capturing should start.
+     RAW->SIZE is zero, and RAW->TRACE is NULL if only the number of
+     words needed is to be counted.
+   Notes:
+     Frames of native code are stored as well, since telling them
+     apart would take as long as finding their methods. */
+static void
+capture_stack (exceptionFrame *base, struct stack_trace *raw)
+{
+    exceptionFrame *frame;
+
+    frame = base;
+    while (frame != NULL && FRAMEOKAY(frame)) {
+#ifdef INTERPRETER
+	if (intrp_inside_interpreter((void*)PCFRAME(frame))) {
+	    frame = intrp_walk_stack(frame, store_frame, raw);
+	    continue;
+	}
+#endif /* INTERPRETER */
+
+#ifdef TRANSLATOR
+	if (raw->trace != NULL)
+	    raw->trace[raw->size+3] = (jword)(PCFRAME(frame) | RAW_PC_TAG);
+	raw->size++;
+#endif /* TRANSLATOR */
+	NEXTFRAME(frame);
+    }
+}
+
+/* Name        : resolve_raw_trace
+   Description : Process each frame of a raw stack trace.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
+   Pre-condition:
+     RAW was returned by buildStackTrace().
+     FUNC is the guard function.
+     INFO is a pointer that may be used by FUNC. */
+static void
+resolve_raw_trace (jword *raw, guard func, void *info)
+{
+    int i, n;
+    jword entry;
+
+    n = -(int)raw[1];
+    for (i = 0; i < n; i++) {
+	entry = raw[i+3];
+
+	if ((entry & RAW_PC_TAG) == 0) {
+	    /* Interpreter frame. */
+	    i++;
+	    if (func((Method*)entry, (int)raw[i+3], info) != 0)
+		return;
+	    continue;
+	}
+
+#ifdef TRANSLATOR
+	{
+	    MethodInstance *instance;
+	    uintp pc;
+
+	    pc = (uintp)(entry & ~RAW_PC_TAG);
+
+#ifdef METHOD_COUNT
+	    {
+		ReclaimedFrame *frames;
+		int depth, j;
+
+		/* The code has been freed, and the PC may now be in
+		   other code, so use the frames kept for it. */
+		if (CSW_find_reclaimed_frames(pc, (int)raw[2],
+					      &frames, &depth)) {
+		    for (j = 0; j < depth; j++)
+			if (func(frames[j].method, frames[j].bpc, info) != 0)
+			    return;
+		    continue;
+		}
+	    }
+#endif /* METHOD_COUNT */
+
+	    instance = findMethodFromPC(pc);
+	    if (instance == NULL)
+		continue;
+
+#ifndef INTERPRETER
+	    if (!MI_IsLaTTeTranslated(instance)) {
+		if (func(MI_GetMethod(instance), -1, info) != 0)
+		    return;
+		continue;
+	    }
+#endif /* not INTERPRETER */
+
+	    if (MI_walk_pc(instance, pc, func, info) != 0)
+		return;
+	}
+#endif /* TRANSLATOR */
+    }
+}
+
 /* Name        : walk_stack
    Description : Walk the stack, processing each stack frame.
    Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
@@ -380,6 +563,51 @@ walk_stack (exceptionFrame *base, guard func, void *info)
     }
 }
 
+/* Name        : walk_thread_frames
+   Description : Walk the raw stack frames of a thread.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr>
+   Pre-condition:
+     TID is a live thread.  Unless it is the current thread, it must
+     be suspended, so that its register windows are on its stack.
+     FUNC is called with the return PC of each frame and INFO, and
+     returns a non-zero value iff. stack walking should be stopped.
+   Notes:
+     Unlike walk_stack(), frames are not mapped to methods, so this
+     can be used to find frames executing arbitrary code. */
+void
+walk_thread_frames (Hjava_lang_Thread *tid, frame_guard func, void *info)
+{
+    exceptionFrame *frame;
+    ctx *ct;
+
+    if (unhand(tid)->PrivateInfo == 0)
+	return;
+
+    ct = TCTX(tid);
+
+    if (tid == currentThread) {
+	register exceptionFrame *sp asm("%sp");
+
+	asm volatile ("ta 3"); /* Spill registers. */
+	frame = sp;
+    } else {
+	frame = (exceptionFrame*)ct->restorePoint;
+    }
+
+    while (frame != NULL
+	   && (uint8*)frame >= ct->stackBase
+	   && (uint8*)frame < ct->stackEnd) {
+	if (PCFRAME(frame) != 0 && func(PCFRAME(frame), info) != 0)
+	    return;
+
+	/* Frames must move towards the stack base. */
+	if ((exceptionFrame*)frame->retbp <= frame)
+	    return;
+
+	NEXTFRAME(frame);
+    }
+}
+
 /* Name        : fill_in_context
    Description : Fill in class context.
    Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr> */
@@ -457,9 +685,29 @@ fill_in_trace (Method *m, int bpc, void *info)
     struct stack_trace *trace;
 
     trace = (struct stack_trace*)info;
+    if (trace->size == (int)trace->trace[1])
+	return 1;	/* The trace is full. */
     trace->trace[2*trace->size+2] = (jword)m;
     trace->trace[2*trace->size+3] = (jword)bpc;
     trace->size++;
 
+    return 0;
+}
+
+/* Name        : store_frame
+   Description : Store an interpreter frame in a raw stack trace.
+   Maintainer  : Yoo C. Chung <chungyc@altair.snu.ac.kr> */
+static int
+store_frame (Method *m, int bpc, void *info)
+{
+    struct stack_trace *raw;
+
+    raw = (struct stack_trace*)info;
+    if (raw->trace != NULL) {
+	raw->trace[raw->size+3] = (jword)m;
+	raw->trace[raw->size+4] = (jword)bpc;
+    }
+    raw->size += 2;
+
     return 0;	/* Always continue walking stack. */
 }
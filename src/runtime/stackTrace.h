@@ -14,8 +14,16 @@
 #define __stacktrace_h
 
 Hjava_lang_Object*	buildStackTrace(struct _exceptionFrame* base);
+Hjava_lang_Object*	resolveStackTrace(Hjava_lang_Object* trace);
 Hjava_lang_Object*	getClassContext(void* bulk);
 Hjava_lang_Class*	getClassWithLoader(int* depth);
 jint			classDepth(char* name);
 
+/* Accepts the return PC of a stack frame and an extra pointer, and
+   returns a non-zero value iff. stack walking should be stopped. */
+typedef int (*frame_guard) (uintp, void*);
+
+void			walk_thread_frames(struct Hjava_lang_Thread* tid,
+					   frame_guard func, void* info);
+
 #endif
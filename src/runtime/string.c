@@ -27,10 +27,35 @@ int32 hashChars (jchar* ptr, int length);
 
 #if INTERN_UTF8CONSTS
 
-static Utf8Const** utf8hash = NULL;
-static int utf8hash_size = 0;  /* Number of slots available in utf8hash.
-			        * Assumed be power of 2! */
+/* Interned Utf8Consts are kept in an open addressed hash table with
+ * linear probing, along with their hash values.  Lookups are done
+ * without locking: a slot is filled by storing the hash before the
+ * constant, and a grown table is filled before it replaces the old
+ * one, which is not freed since a lookup may still be using it.
+ * Insertions are serialized by utf8lock. */
+typedef struct utf8Slots {
+	int			size;	/* Power of 2 */
+	struct {
+		uint32		hash;
+		Utf8Const*	utf8;
+	} slot[1];
+} utf8Slots;
+
+#define	UTF8HASHSZ	1024
+
+static utf8Slots* utf8hash = NULL;
 static int utf8hash_count = 0;  /* Number of slots used in utf8hash. */
+static quickLock utf8lock;
+
+/* Interned constants are never freed, since classes are never
+ * unloaded.  So they are carved out of large chunks of fixed memory,
+ * instead of each being a separate object in the heap. */
+#define	UTF8CHUNKSZ	16384
+#define	UTF8ALIGN	8
+
+static char* utf8chunk_point = NULL;
+static char* utf8chunk_bound = NULL;
+
 #define HASH_CHARS(STR, LEN) hashChars(STR, LEN)
 
 #else
@@ -95,114 +120,137 @@ hashUtf8String (char* str, int len)
     return hash;
 }
 
-void 
-finalizeUtf8const(void* mem){
-    unsigned int hash;
-	register unsigned int index;
-	int step;
-	Utf8Const* m;
-    int len;
-
-    m = (Utf8Const*)mem;    
-    len = m->length;
-    hash = hashUtf8String( m->data, len);
-    index = hash % utf8hash_size;
-    step = 0;
-
-    while (utf8hash[index] == (Utf8Const *) -1 ||
-           !( utf8hash[ index ]->length == len &&
-              memcmp( utf8hash[ index ]->data, m->data, len ) == 0 ) )  {
-        index += 2 * (++step) - 1; // use quadratic probing
-        index %= utf8hash_size;
-    }
-    assert(utf8hash[index] != NULL);
-    utf8hash_count--;
-    utf8hash[index] = (Utf8Const *) -1;
+#if INTERN_UTF8CONSTS
+static
+utf8Slots*
+newUtf8Slots (int size)
+{
+	utf8Slots* slots;
+
+	slots = gc_malloc_fixed(sizeof(utf8Slots)
+				+ (size - 1) * sizeof(slots->slot[0]));
+	slots->size = size;
+	return (slots);
 }
 
-  
-#if INTERN_UTF8CONSTS
-/* Find the correct slot in utf8hash for the given string. */
+/* Look for the string S of length LEN with hash HASH in SLOTS.
+ * Returns the index of its slot, or of the empty slot where it
+ * should go. */
 static
-Utf8Const**
-find_utf8hash (char* s, int len)
-{	
-	unsigned int hash;
-	register unsigned int index;
-	int step;
-
-
-    hash = hashUtf8String( s, len );
-    index = hash % utf8hash_size;
-    step = 0;
-
-    while ( utf8hash[ index ] != NULL && (utf8hash[index] == (Utf8Const *) -1 ||
-            !( utf8hash[ index ]->length == len &&
-               memcmp( utf8hash[ index ]->data, s, len ) == 0 ) )) {
-        index += 2 * (++step) - 1; // use quadratic probing
-        index %= utf8hash_size;
-    }
+int
+findUtf8Slot (utf8Slots* slots, char* s, int len, uint32 hash)
+{
+	Utf8Const* m;
+	int i;
 
-    return &utf8hash[ index ];
+	for (i = hash & (slots->size - 1);
+	     (m = slots->slot[i].utf8) != NULL;
+	     i = (i + 1) & (slots->size - 1)) {
+		if (slots->slot[i].hash == hash && m->length == len
+		    && memcmp(m->data, s, len) == 0) {
+			break;
+		}
+	}
+	return (i);
+}
+
+/* Allocate a constant of length LEN from the current chunk.  Must be
+ * called with utf8lock held. */
+static
+Utf8Const*
+allocUtf8Const (int len)
+{
+	Utf8Const* m;
+	size_t size;
 
+	size = (sizeof(Utf8Const) + len + UTF8ALIGN) & -UTF8ALIGN;
+	if (utf8chunk_bound - utf8chunk_point < size) {
+		/* Long constants don't waste the rest of the chunk */
+		if (size > UTF8CHUNKSZ / 4) {
+			return ((Utf8Const*)gc_malloc_fixed(size));
+		}
+		utf8chunk_point = gc_malloc_fixed(UTF8CHUNKSZ);
+		utf8chunk_bound = utf8chunk_point + UTF8CHUNKSZ;
+	}
+	m = (Utf8Const*)utf8chunk_point;
+	utf8chunk_point += size;
+	return (m);
 }
 #endif
 
-#include "prime.h"
-
 Utf8Const*
 makeUtf8Const (char* s, int len)
 {
 	Utf8Const* m;
 #if INTERN_UTF8CONSTS
-	Utf8Const** ptr;
+	utf8Slots* slots;
+	utf8Slots* nslots;
+	uint32 hash;
+	int i;
+	int j;
 #endif
 	if (len < 0) {
 		len = strlen (s);
 	}
 #if INTERN_UTF8CONSTS
+	hash = hashUtf8String(s, len);
 
-    if (3 * utf8hash_count >= 2 * utf8hash_size) { // load factor is 2/3.
+	slots = utf8hash;
+	if (slots != NULL) {
+		m = slots->slot[findUtf8Slot(slots, s, len, hash)].utf8;
+		if (m != NULL) {
+			return (m);
+		}
+	}
 
-		if (utf8hash == NULL) {
-			utf8hash_size = 1021;
+	lockMutex(&utf8lock);
 
-			utf8hash =
-				gc_calloc(utf8hash_size, sizeof(Utf8Const*),
-					  &gc_fixed);
+	/* Look again, in case another thread has entered it */
+	slots = utf8hash;
+	if (slots != NULL) {
+		m = slots->slot[findUtf8Slot(slots, s, len, hash)].utf8;
+		if (m != NULL) {
+			unlockMutex(&utf8lock);
+			return (m);
 		}
-		else {	/* Re-hash */
-			register int i = utf8hash_size;
-			register Utf8Const** ptr = utf8hash + i;
-			register Utf8Const** old_hash = utf8hash;
-			utf8hash_size = get_next_prime( utf8hash_size * 2 );
-			utf8hash = gc_calloc( utf8hash_size,
-					      sizeof( Utf8Const* ),
-					      &gc_fixed );
-
-			while (--i >= 0) {
-//				if (*--ptr != NULL) {
-				if (*--ptr > 0) {
-					*find_utf8hash((*ptr)->data,
-						       (*ptr)->length) = *ptr;
-				}
+	}
+
+	/* Keep the table at most half full */
+	if (slots == NULL) {
+		utf8hash = slots = newUtf8Slots(UTF8HASHSZ);
+	}
+	else if (2 * (utf8hash_count + 1) > slots->size) {
+		nslots = newUtf8Slots(2 * slots->size);
+		for (i = 0; i < slots->size; i++) {
+			if (slots->slot[i].utf8 != NULL) {
+				for (j = slots->slot[i].hash & (nslots->size - 1);
+				     nslots->slot[j].utf8 != NULL;
+				     j = (j + 1) & (nslots->size - 1))
+					;
+				nslots->slot[j].hash = slots->slot[i].hash;
+				nslots->slot[j].utf8 = slots->slot[i].utf8;
 			}
-			gc_free(old_hash);
 		}
+		utf8hash = slots = nslots;
 	}
-	ptr = find_utf8hash (s, len);
-	if (*ptr != 0) {
-		return (*ptr);
-	}
-#endif
-	m = (Utf8Const*)gc_malloc(sizeof(Utf8Const) + len + 1, &gc_utf8const);
+
+	m = allocUtf8Const(len);
 	memcpy (m->data, s, len);
 	m->data[len] = 0;
 	m->length = len;
-#if INTERN_UTF8CONSTS
-	*ptr = m;
+
+	/* The hash must be set before the constant makes the slot visible */
+	i = findUtf8Slot(slots, s, len, hash);
+	slots->slot[i].hash = hash;
+	slots->slot[i].utf8 = m;
 	utf8hash_count++;
+
+	unlockMutex(&utf8lock);
 #else
+	m = (Utf8Const*)gc_malloc(sizeof(Utf8Const) + len + 1, &gc_utf8const);
+	memcpy (m->data, s, len);
+	m->data[len] = 0;
+	m->length = len;
 	m->hash = (uint16) hashUtf8String (s, len);
 #endif
 	return (m);
@@ -39,6 +39,10 @@
 /* Anchor point for user defined properties */
 userProperty* userProperties;
 
+/* When main() is called, and the number of classes loaded by then */
+struct timeval main_entry_time;
+int num_of_classes_before_main;
+
 #if defined(NO_SHARED_LIBRARIES)
 /* Internal native functions */
 static nativeFunction null_funcs[1];
@@ -271,6 +275,9 @@ do_execute_java_main_method(char* cname, ...)
 	exit(1);
     }
 
+    gettimeofday(&main_entry_time, NULL);
+    num_of_classes_before_main = num_of_loaded_classes;
+
     /* Make the call */
     va_start(argptr, cname);
     CALL_KAFFE_STATIC_VARARGS(METHOD_NATIVECODE(mb), MAINARGSIZE, argptr, retval);
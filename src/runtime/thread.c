@@ -52,7 +52,6 @@ extern void*       translator_stack;
 
 static void firstStartThread(void);
 static void createInitialThread(char*);
-static Hjava_lang_Thread* createDaemon(void*, char*);
 
 /****/
 static int numberOfThreads;
@@ -98,8 +97,9 @@ initThreads(void)
 
 #if defined(GC_ENABLE)
 	/* Start the GC daemons we need */
-	finalman_thread = createDaemon(&gc_finalize_main, "finaliser");
-	garbageman = createDaemon(&gc_main, "gc");
+	finalman_thread = createDaemon(&gc_finalize_main, "finaliser",
+				       java_lang_Thread_MAX_PRIORITY);
+	garbageman = createDaemon(&gc_main, "gc", java_lang_Thread_MAX_PRIORITY);
 	gc_mode = GC_ENABLED;
 #endif
 
@@ -181,11 +181,10 @@ createInitialThread(char* nm)
 }
 
 /*
- * Start a daemon thread.
+ * Start a daemon thread running FUNC at the given priority.
  */
-static
 Hjava_lang_Thread*
-createDaemon(void* func, char* nm)
+createDaemon(void* func, char* nm, int priority)
 {
 	Hjava_lang_Thread* tid;
 
@@ -196,7 +195,7 @@ DBG(	printf("createDaemon %s\n", nm);				)
 	assert(tid != 0);
 
 	unhand(tid)->name = (HArrayOfChar*)makeJavaCharArray(nm, strlen(nm));
-	unhand(tid)->priority = java_lang_Thread_MAX_PRIORITY;
+	unhand(tid)->priority = priority;
 	unhand(tid)->threadQ = 0;
 	unhand(tid)->single_step = 0;
 	unhand(tid)->daemon = 1;
@@ -47,6 +47,7 @@ void	resumeThread(Hjava_lang_Thread*);
 void	suspendThread(Hjava_lang_Thread*);
 void	startThread(Hjava_lang_Thread*);
 void	stopThread(Hjava_lang_Thread*);
+Hjava_lang_Thread* createDaemon(void*, char*, int);
 
 extern int threadStackSize;
 extern Hjava_lang_Thread* currentThread;
@@ -13,6 +13,10 @@ Written by Per Bothner <bothner@cygnus.com>, February 1996.
 #include "config.h"
 #include "zipfile.h"
 
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+#include <zlib.h>
+#endif
+
 /* This stuff is partly based on the 28 August 1994 public release of the
 Info-ZIP group's portable UnZip zipfile-extraction program (and related
 utilities). */
@@ -198,6 +202,20 @@ typedef unsigned int      ulg;  /*  predefined on some systems) & match zip  */
 #endif
 
 
+/***********************/
+/* Function hashname() */
+/***********************/
+
+static inline ulg hashname(const char* name)
+{
+    ulg hash = 0;
+
+    while (*name != 0)
+	hash = hash * 31 + (uch) *name++;
+    return hash;
+}
+
+
 /***********************/
 /* Function makeword() */
 /***********************/
@@ -296,6 +314,7 @@ read_zip_archive (zipf)
   for (i = 0; i < zipf->count; i++)
     {
       ZipDirectory *zipd = (ZipDirectory*)(dir_ptr + dir_last_pad);
+      int compression_method = makeword (&dir_ptr[4+C_COMPRESSION_METHOD]);
       long compressed_size = makelong (&dir_ptr[4+C_COMPRESSED_SIZE]);
       long uncompressed_size = makelong (&dir_ptr[4+C_UNCOMPRESSED_SIZE]);
       long filename_length = makeword (&dir_ptr[4+C_FILENAME_LENGTH]);
@@ -311,8 +330,16 @@ read_zip_archive (zipf)
 	return -1;
 
       zipd->filename_length = filename_length;
-      if (compressed_size == uncompressed_size)
+      zipd->compressed_size = 0;
+      if (compression_method == STORED)
 	zipd->size = uncompressed_size;
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+      else if (compression_method == DEFLATED)
+	{
+	  zipd->size = uncompressed_size;
+	  zipd->compressed_size = compressed_size;
+	}
+#endif
       else
 	zipd->size = -1;	/* File is compressed - we cannot handle */
 #if defined(__GNUC__)
@@ -320,12 +347,7 @@ read_zip_archive (zipf)
 #else
 #define DIR_ALIGN sizeof(long)
 #endif
-      zipd->filestart = makelong (&dir_ptr[4+C_RELATIVE_OFFSET_LOCAL_HEADER])
-	+ (LREC_SIZE+4) + record_length;
-      /* This is definately a hack - but it fixes things for now */
-      if (record_length != filename_length) {
-	zipd->filestart += 4;
-      }
+      zipd->localstart = makelong (&dir_ptr[4+C_RELATIVE_OFFSET_LOCAL_HEADER]);
       zipd->filename_offset = CREC_SIZE+4 - dir_last_pad;
       unpadded_direntry_length = zipd->filename_offset + record_length;
       zipd->direntry_size =
@@ -336,6 +358,30 @@ read_zip_archive (zipf)
       dir_ptr = (char*)zipd + unpadded_direntry_length;
     }
 
+  /* Index the directory by file name, so that lookups need not scan
+     it.  The table is at most half full, so probing always ends at an
+     empty slot. */
+  {
+    ZipDirectory **index;
+    ZipDirectory *zipd;
+    long size;
+    ulg h;
+
+    for (size = 16; size < 2 * zipf->count; size <<= 1)
+      ;
+    index = gc_malloc_fixed (size * sizeof(ZipDirectory*));
+    zipd = (ZipDirectory*) zipf->central_directory;
+    for (i = 0; i < zipf->count; i++, zipd = ZIPDIR_NEXT (zipd))
+      {
+	h = hashname (ZIPDIR_FILENAME (zipd)) & (size - 1);
+	while (index[h] != 0)
+	  h = (h + 1) & (size - 1);
+	index[h] = zipd;
+      }
+    zipf->index_size = size;
+    zipf->index = index;
+  }
+
 #if defined(HAVE_MMAP) && defined(HAVE_UNALIGNEDACCESS)
   /* Now that we're done mucking, set the whole thing back read-only.  */
   i = zipf->size;
@@ -351,6 +397,104 @@ read_zip_archive (zipf)
   return 0;
 }
 
+/* Return the directory entry of the named file, or 0 if there is no
+   such file in the archive. */
+ZipDirectory *
+find_zip_entry (zipf, name)
+     ZipFile *zipf;
+     const char *name;
+{
+  ZipDirectory *zipd;
+  ulg h;
+
+  h = hashname (name) & (zipf->index_size - 1);
+  while ((zipd = zipf->index[h]) != 0)
+    {
+      if (strcmp (name, ZIPDIR_FILENAME (zipd)) == 0)
+	return zipd;
+      h = (h + 1) & (zipf->index_size - 1);
+    }
+  return 0;
+}
+
+/* Return the offset of the data of ZIPD in the archive, or -1 on error.
+   The extra field of the local header need not be the same as the one
+   in the central directory, so the local header is read, from FD unless
+   the archive is mapped.  The header and the data must lie within the
+   archive, since a mapped archive is read without further checks. */
+long
+zip_entry_start (zipf, zipd, fd)
+     ZipFile *zipf;
+     ZipDirectory *zipd;
+     int fd;
+{
+  long start, length;
+#if defined(HAVE_MMAP) && defined(HAVE_UNALIGNEDACCESS)
+  char *buffer;
+
+  if (zipd->localstart < 0 || zipd->localstart > zipf->size - (LREC_SIZE+4))
+    return -1;
+  buffer = zipf->mmap_base + zipd->localstart;
+#else
+  char buffer[LREC_SIZE+4];
+
+  if (lseek (fd, zipd->localstart, SEEK_SET) < 0)
+    return -1;
+  if (read (fd, buffer, LREC_SIZE+4) != LREC_SIZE+4)
+    return -1;
+#endif
+
+  start = zipd->localstart + (LREC_SIZE+4)
+    + makeword (&buffer[4+L_FILENAME_LENGTH])
+    + makeword (&buffer[4+L_EXTRA_FIELD_LENGTH]);
+
+  length = zipd->compressed_size != 0 ? zipd->compressed_size : zipd->size;
+  if (start > zipf->size || length < 0 || length > zipf->size - start)
+    return -1;
+  return start;
+}
+
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+/* Inflate IN_SIZE bytes of deflated data at IN into the OUT_SIZE bytes
+   at OUT.  Returns 0 if exactly OUT_SIZE bytes were inflated. */
+int
+inflate_zip_entry (in, in_size, out, out_size)
+     char *in;
+     long in_size;
+     char *out;
+     long out_size;
+{
+  z_stream stream;
+  int r;
+
+  memset (&stream, 0, sizeof(stream));
+  /* Zip entries are raw deflate data without the zlib header. */
+  if (inflateInit2 (&stream, -MAX_WBITS) != Z_OK)
+    return -1;
+
+  stream.next_in = (Bytef*) in;
+  stream.avail_in = in_size;
+  stream.next_out = (Bytef*) out;
+  stream.avail_out = out_size;
+  r = inflate (&stream, Z_FINISH);
+  inflateEnd (&stream);
+
+  if (r != Z_STREAM_END || stream.total_out != out_size)
+    return -1;
+  return 0;
+}
+#else
+int
+inflate_zip_entry (in, in_size, out, out_size)
+     char *in;
+     long in_size;
+     char *out;
+     long out_size;
+{
+  return -1;
+}
+#endif
+
 #ifdef TEST
 main ()
 {
@@ -373,7 +517,7 @@ main ()
       printf ("%d: size:%d, name(#%d)%s, offset:%d\n",
 	      i, zipd->size, zipd->filename_length,
 	      ZIPDIR_FILENAME (zipd),
-	      zipd->filestart);
+	      zipd->localstart);
     }
 }
 #endif
@@ -15,6 +15,11 @@ struct ZipFile {
   long dir_size;
   char *central_directory;
   char *mmap_base;
+  /* Open addressed hash table of the directory entries, keyed by file
+     name.  Its size is a power of two.  It is set last, so the archive
+     can be searched without locking once it is non-null. */
+  struct ZipDirectory **index;
+  long index_size;
 };
 
 typedef struct ZipFile ZipFile;
@@ -22,9 +27,10 @@ typedef struct ZipFile ZipFile;
 struct ZipDirectory {
   int direntry_size;
   int filename_offset;
-  long size; /* length of file */
-  long filestart;  /* start of file in archive */
-  long filename_length;
+  long size; /* length of file, -1 if it can't be extracted */
+  long localstart;  /* start of local file header in archive */
+  int filename_length;
+  int compressed_size; /* length of deflated data, 0 if file is stored */
   /* char mid_padding[...]; */
   /* char filename[filename_length]; */
   /* char end_padding[...]; */
@@ -38,3 +44,6 @@ typedef struct ZipDirectory ZipDirectory;
 
 
 int read_zip_archive(ZipFile*);
+ZipDirectory *find_zip_entry(ZipFile*, const char*);
+long zip_entry_start(ZipFile*, ZipDirectory*, int);
+int inflate_zip_entry(char*, long, char*, long);
@@ -5,6 +5,7 @@
 #include "SPARC_instr.h"
 #include "method_inlining.h"
 #include "TypeChecker.h"
+#include "PolymorphicInlineCache.h"
 #include "translator_driver.h"
 #ifdef CUSTOMIZATION
 #include "SpecializedMethod.h"
@@ -15,6 +16,18 @@
 // static utility functions
 //////////////////////////////////////////////////////////////////////
 
+// The hits may change while the caller is retranslated, so the first
+// receiver type is used if no type dominates any more.
+static inline
+PICEntry*
+find_dominant_entry_from_call_site( unsigned* call_site_addr )
+{
+    PolymorphicInlineCache* pic = PIC_find_from_call_site( call_site_addr );
+    PICEntry* entry = PIC_get_dominant_entry( pic );
+
+    return entry != NULL ? entry : &pic->entries[0];
+}
+
 static inline
 Method*
 find_called_method_from_call_site( unsigned* call_site_addr )
@@ -31,6 +44,10 @@ find_called_method_from_call_site( unsigned* call_site_addr )
     // target address of call op. = current pc + 4*disp30
     called_method_start_addr = call_site_addr + disp30;
 
+    // a PIC is only called in this state if it has a dominant entry
+    if (*(called_method_start_addr-2) == 0)
+      return find_dominant_entry_from_call_site( call_site_addr )->method;
+
     method = (Method*)*(called_method_start_addr-1);
 
     return method;
@@ -52,6 +69,9 @@ find_receiver_type_from_call_site( unsigned* call_site_addr )
     // target address of call op. = current pc + 4*disp30
     called_method_start_addr = call_site_addr + disp30;
 
+    if (*(called_method_start_addr-2) == 0)
+      return find_dominant_entry_from_call_site( call_site_addr )->type;
+
     type = (Hjava_lang_Class*)*(called_method_start_addr - 2);
 
     return type;
@@ -69,6 +89,8 @@ get_inline_cache_status( unsigned* call_site_addr )
     // 1. call
     //     if (target address of the call == 'dispatch_method')
     //       return 0
+    //     else if (target of the call is a polymorphic inline cache)
+    //       return 3
     //     else 
     //       return 1
     // 2. jmpl
@@ -80,6 +102,8 @@ get_inline_cache_status( unsigned* call_site_addr )
 
         if ( target_addr == (unsigned*)dispatch_method_with_inlinecache ) 
           return 0; 
+        else if ( PIC_find_from_call_site( call_site_addr ) != NULL )
+          return 3;
         else 
           return 1;
 
@@ -140,7 +164,6 @@ CSIT_Find( CallSiteInfoTable *csit, uint32 bpc )
 // CSIT_Find() can be called in CSIT_Insert(). 
 //     assert( CSI_GetPointer(result) != 0 
 //             && (unsigned)CSI_GetPointer( result ) % 4 == 0 );
-    assert( CSI_GetState( result ) != 3 ); 
 
     return result; 
 }
@@ -189,7 +212,14 @@ if( There is no data ){
     } else {
         use ld-ld-jmpl;
     }
-} else { // polymorphic site(more than one)
+} else if( polymorphic site with a few receiver types ){
+    // call polymorphic inline cache
+    if( one receiver type dominates and appropriate to inline ){
+        if-inline; 
+    } else {
+        keep inline cache; 
+    }
+} else { // megamorphic site(more than The_PIC_Max_Size)
     // jmpl
     use ld-ld-jmpl; 
 }
@@ -206,8 +236,12 @@ if( There is no data ){
        Return Value: 
        if 0(CSI_UNKNOWN), use inline cache,
        else if CSI_JMPL, use ld-ld-jmpl,
+       else if CSI_POLYMORPHIC, use inline cache, which will become
+       a polymorphic inline cache again,
        else a pointer to Method to if-inline.    
-   Notes:  */
+   Notes:
+       A call site which calls a polymorphic inline cache is if-inlined
+       for the receiver type which takes most of the hits. */
 unsigned
 find_appropriate_virtual_call_implementation_type( Method *method, uint32 bpc )
 {
@@ -223,7 +257,7 @@ find_appropriate_virtual_call_implementation_type( Method *method, uint32 bpc )
     call_site_info = CSIT_Find( method->callSiteInfoTable, bpc ); 
     state = CSI_GetState( call_site_info ); 
 
-    if( state == CSI_UNKNOWN ){
+    if( state != CSI_JMPL ){
         unsigned new_state = -1;    // to avoid uninitialization warning
         unsigned *call_site_addr;
 
@@ -251,6 +285,19 @@ find_appropriate_virtual_call_implementation_type( Method *method, uint32 bpc )
           case 2: // multiple target...
             new_state = CSI_JMPL;
             break; 
+
+          // case "call polymorphic inline cache":
+          case 3: // a few targets...
+          {
+            PolymorphicInlineCache* pic = 
+                PIC_find_from_call_site( call_site_addr );
+
+            if ( PIC_get_dominant_entry( pic ) != NULL )
+              new_state = CSI_IFINLINE; 
+            else
+              new_state = CSI_POLYMORPHIC; 
+            break; 
+          }
           default:
             assert(0);
             break; 
@@ -259,20 +306,11 @@ find_appropriate_virtual_call_implementation_type( Method *method, uint32 bpc )
         CSI_SetState( call_site_info, new_state ); 
         state = new_state; 
     } 
-    else if ( state == CSI_IFINLINE ) {
-        unsigned *call_site_addr;
-
-        call_site_addr = (unsigned*)CSI_GetPointer( call_site_info ); 
-        if ( get_inline_cache_status( call_site_addr ) == 2 ){// change to jmpl
-            CSI_SetState( call_site_info, CSI_JMPL ); 
-            state = CSI_JMPL;
-        }
-    }
 
     if( state == CSI_IFINLINE ){
         return (unsigned)find_called_method_from_call_site( (unsigned*)CSI_GetPointer( call_site_info ) );
     } else {
-        assert( state == CSI_JMPL ); 
+        assert( state == CSI_JMPL || state == CSI_POLYMORPHIC ); 
         return state; 
     }
 }
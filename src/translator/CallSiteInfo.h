@@ -34,7 +34,7 @@ typedef CallSiteInfo CallSiteInfoTable;
 
 void     CSIT_Insert(CallSiteInfoTable *csit, uint32 bpc, uint32 npc); 
 
-enum { CSI_UNKNOWN = 0, CSI_IFINLINE, CSI_JMPL }; 
+enum { CSI_UNKNOWN = 0, CSI_IFINLINE, CSI_JMPL, CSI_POLYMORPHIC }; 
 unsigned find_appropriate_virtual_call_implementation_type(Method *method, 
                                                            uint32 bpc); 
 
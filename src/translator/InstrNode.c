@@ -1333,6 +1333,10 @@ OpcodeName SPARCOpcodeNames[] = {
     { FMOVD, "fmovd" },
     { FNEGS, "fnegs" },
     { FNEGD, "fnegd" },
+    { FABSS, "fabss" },
+    { FABSD, "fabsd" },
+    { FSQRTS, "fsqrts" },
+    { FSQRTD, "fsqrtd" },
 
     { FADDS, "fadds" },
     { FADDD, "faddd" },
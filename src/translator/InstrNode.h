@@ -375,6 +375,8 @@ bool         Instr_IsTrap(InstrNode* c_instr);
 bool         Instr_IsIBranch(InstrNode* c_instr);
 bool         Instr_IsFBranch(InstrNode* c_instr);
 void         Instr_PredictTaken(InstrNode* c_instr);
+bool         Instr_IsCondBranch(InstrNode* c_instr);
+void         Instr_NegateBranch(InstrNode* c_instr);
 void         Instr_PredictUnTaken(InstrNode* c_instr);
 bool	     Instr_IsExceptionReturn(InstrNode *c_instr);
 void	     Instr_SetExceptionReturn(InstrNode *c_instr);
@@ -29,9 +29,11 @@ JIT_OBJECTS=\
 		stat.o \
 		method_inlining.o \
 		mem_allocator_for_code.o \
+		code_sweeper.o \
 		live_analysis.o \
 		value_numbering.o \
 		loop_opt.o \
+		escape_analysis.o \
 		sma.o \
 		functions.o \
 		translator_driver.o \
@@ -39,7 +41,9 @@ JIT_OBJECTS=\
 		reg_alloc_util.o \
 		plist.o \
 		utils.o \
-		dynamic_cha.o
+		dynamic_cha.o \
+		jit_log.o \
+		bytecode_profile.o
 
 
 OBJECTS		+= $(JIT_OBJECTS)
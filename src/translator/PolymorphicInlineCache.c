@@ -0,0 +1,312 @@
+/* PolymorphicInlineCache.c
+   Support for polymorphic inline cache.
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#include <assert.h>
+#include "config.h"
+#include "classMethod.h"
+#include "md.h"
+#include "gc.h"
+#include "flags.h"
+#include "SPARC_instr.h"
+#include "reg.h"
+#include "method_inlining.h"
+#include "translator_driver.h"
+#include "PolymorphicInlineCache.h"
+
+#define PIC_ALLOC(a) gc_malloc_fixed(a)
+
+/* an entry is dominant if it takes this percentage of the hits */
+#define PIC_DOMINANT_PERCENT 80
+
+int The_PIC_Max_Size = 4;
+
+/* all the PICs, for retranslation of the called methods */
+static PolymorphicInlineCache* pic_list = NULL;
+
+
+static inline
+unsigned*
+PIC_entry_code(PolymorphicInlineCache* pic, int idx)
+{
+    return pic->code + OFFSET_OF_PIC_CODE_START + 1
+        + idx * PIC_ENTRY_INSTR_NUM;
+}
+
+static inline
+unsigned*
+PIC_miss_code(PolymorphicInlineCache* pic)
+{
+    return PIC_entry_code(pic, pic->capacity);
+}
+
+/* Name        : PIC_count_hits_at
+   Description : check whether hits at the call site are worth counting
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+   Notes: only the code which is going to be retranslated uses them */
+static
+bool
+PIC_count_hits_at(unsigned* call_site)
+{
+#ifdef METHOD_COUNT
+    MethodInstance* instance;
+
+    if (!flag_adapt)
+      return false;
+
+    instance = findMethodFromPC((uintp) call_site);
+
+    return instance != NULL && MI_IsLightTranslated(instance);
+#else
+    return false;
+#endif
+}
+
+/* Name        : PIC_make_entry_code
+   Description : make the check code for an entry
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       no thread executes the entry except its first instruction
+   Post-condition:
+   Notes:
+       The first instruction, which jumps to the miss handler in an
+       unused entry, is written last. */
+static
+void
+PIC_make_entry_code(PolymorphicInlineCache* pic, int idx)
+{
+    PICEntry* entry = &pic->entries[idx];
+    unsigned* start = PIC_entry_code(pic, idx);
+    unsigned* code = start + 1;
+    int count_offset = LO(entry) + ((char*)&entry->count - (char*)entry);
+    int body_offset = LO(entry) + ((char*)&entry->body - (char*)entry);
+
+    *code++ = assemble_instr5(OR, g4, g4, LO(entry->type->dtable));
+    *code++ = assemble_instr6(SUBCC, g0, g3, g4);
+    *code++ = assemble_instr3(BNE, PIC_ENTRY_INSTR_NUM - 3);
+    *code++ = assemble_instr2(SETHI, g4, HI(entry));
+    if (pic->countHits) {
+        *code++ = assemble_instr5(LD, g3, g4, count_offset);
+        *code++ = assemble_instr5(ADD, g3, g3, 1);
+        *code++ = assemble_instr8(ST, g3, g4, count_offset);
+    }
+    *code++ = assemble_instr5(LD, g4, g4, body_offset);
+    *code++ = assemble_instr5(JMPL, g0, g4, 0);
+    *code++ = assemble_nop();
+    while (code < start + PIC_ENTRY_INSTR_NUM)
+      *code++ = 0;
+
+    *start = assemble_instr2(SETHI, g4, HI(entry->type->dtable));
+
+    FLUSH_DCACHE(start, code);
+}
+
+/* Name        : PIC_find_from_call_site
+   Description : find the PIC called at the call site
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       call_site is a call site of inline cache
+   Post-condition:
+   Notes:
+       the word where a type check header keeps its check type is 0
+       in a PIC */
+PolymorphicInlineCache*
+PIC_find_from_call_site(unsigned* call_site)
+{
+    unsigned* target;
+
+    if ((*call_site & CALL) != CALL)
+      return NULL;
+
+    target = call_site + (*call_site & 0x3fffffff);
+    if (target == (unsigned*) dispatch_method_with_inlinecache
+        || target[-2] != 0)
+      return NULL;
+
+    return (PolymorphicInlineCache*) target[-1];
+}
+
+/* Name        : PIC_make_PIC
+   Description : make a PIC whose first entry is the monomorphic inline
+                 cache of the call site
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       The_PIC_Max_Size >= 2
+   Post-condition:
+       the call site calls the PIC
+   Notes:  */
+PolymorphicInlineCache*
+PIC_make_PIC(unsigned* call_site, Hjava_lang_Class* type, Method* meth,
+             void* body)
+{
+    PolymorphicInlineCache* pic;
+    int code_size;
+    unsigned* code;
+    unsigned* start;
+    int i;
+
+    assert(The_PIC_Max_Size >= 2);
+
+    pic = (PolymorphicInlineCache*) PIC_ALLOC(sizeof(PolymorphicInlineCache));
+    pic->capacity = The_PIC_Max_Size;
+    pic->count = 0;
+    pic->countHits = PIC_count_hits_at(call_site);
+    pic->entries = (PICEntry*) PIC_ALLOC(sizeof(PICEntry) * pic->capacity);
+
+    code_size = (OFFSET_OF_PIC_CODE_START + 1
+                 + pic->capacity * PIC_ENTRY_INSTR_NUM + 3) * 4;
+    pic->code = (unsigned*) gc_malloc(code_size, &gc_jit_code);
+
+    code = pic->code;
+    *code++ = 0;
+    *code++ = (unsigned) pic;
+    start = code;
+    *code++ = assemble_instr5(LD, g3, o0, 0);
+
+    for (i = 0; i < pic->capacity; i++) {
+        *code = assemble_instr3(BA, PIC_miss_code(pic) - code) | ANNUL_BIT;
+        code += PIC_ENTRY_INSTR_NUM;
+    }
+
+    assert(code == PIC_miss_code(pic));
+    *code++ = assemble_instr2(SETHI, g4,
+                              HI(extend_polymorphic_inline_cache));
+    *code++ = assemble_instr5(JMPL, g0, g4,
+                              LO(extend_polymorphic_inline_cache));
+    *code++ = assemble_nop();
+
+    FLUSH_DCACHE(pic->code, code);
+
+    registerTypeCheckCode((uintp) start, (uintp) code);
+
+    PIC_add_entry(pic, type, meth, body);
+
+    pic->next = pic_list;
+    pic_list = pic;
+
+    *call_site = assemble_instr1(CALL, start - call_site);
+    FLUSH_DCACHE(call_site, call_site + 1);
+
+    return pic;
+}
+
+/* Name        : PIC_add_entry
+   Description : add an entry for the receiver type
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       'type' is not in the PIC
+   Post-condition:
+   Notes:  */
+bool
+PIC_add_entry(PolymorphicInlineCache* pic, Hjava_lang_Class* type,
+              Method* meth, void* body)
+{
+    PICEntry* entry;
+
+    assert(pic);
+    assert(type);
+    assert(PIC_find_body(pic, type) == NULL);
+
+    if (pic->count == pic->capacity)
+      return false;
+
+    entry = &pic->entries[pic->count];
+    entry->type = type;
+    entry->method = meth;
+    entry->body = body;
+    entry->count = 0;
+
+    PIC_make_entry_code(pic, pic->count);
+    pic->count++;
+
+    return true;
+}
+
+void*
+PIC_find_body(PolymorphicInlineCache* pic, Hjava_lang_Class* type)
+{
+    int i;
+
+    for (i = 0; i < pic->count; i++) {
+        if (pic->entries[i].type == type)
+          return pic->entries[i].body;
+    }
+
+    return NULL;
+}
+
+/* Name        : PIC_get_dominant_entry
+   Description : find the receiver type which takes most of the hits
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+   Notes: NULL if hits are not counted */
+PICEntry*
+PIC_get_dominant_entry(PolymorphicInlineCache* pic)
+{
+    PICEntry* max_entry = NULL;
+    int total = 0;
+    int i;
+
+    for (i = 0; i < pic->count; i++) {
+        total += pic->entries[i].count;
+        if (max_entry == NULL || pic->entries[i].count > max_entry->count)
+          max_entry = &pic->entries[i];
+    }
+
+    if (total == 0 || max_entry->count * 100 < total * PIC_DOMINANT_PERCENT)
+      return NULL;
+
+    return max_entry;
+}
+
+/* Name        : PIC_fixup_bodies
+   Description : When a method is retranslated, all the entries' bodies
+                 which are equal to 'ocode' have to be changed to 'ncode'.
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+   Notes:  */
+void
+PIC_fixup_bodies(void* ocode, void* ncode)
+{
+    PolymorphicInlineCache* pic;
+    int i;
+
+    for (pic = pic_list; pic != NULL; pic = pic->next) {
+        for (i = 0; i < pic->count; i++) {
+            if (pic->entries[i].body == ocode)
+              pic->entries[i].body = ncode;
+        }
+    }
+}
+
+/* Name        : PIC_make_ld_ld_jmpl_code
+   Description : change the call site to 'ld/ld/jmpl' sequence
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+   Notes:
+       the two instructions which set %g2 and %g4 for the inline cache
+       are replaced
+
+   ==========================================================
+      add   %g0, offset, %g2    --->   ld    [%o0], %g1
+      add   %g0, 0, %g4         --->   ld    [%g1+offset], %g1
+      call  header              --->   jmpl  %g1, %o7
+   ========================================================== */
+void
+PIC_make_ld_ld_jmpl_code(unsigned* call_site, int offset)
+{
+    call_site[-2] = assemble_instr5(LD, g1, o0, 0);
+    call_site[-1] = assemble_instr5(LD, g1, g1, offset);
+    call_site[0] = assemble_instr5(JMPL, o7, g1, 0);
+
+    FLUSH_DCACHE(call_site - 2, call_site + 1);
+}
@@ -0,0 +1,104 @@
+/* PolymorphicInlineCache.h
+   Support for polymorphic inline cache
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#ifndef __PolymorphicInlineCache_h__
+#define __PolymorphicInlineCache_h__
+
+#include "basic.h"
+#include "classMethod.h"
+
+/* code size of an entry in word */
+#define  PIC_ENTRY_INSTR_NUM        11
+
+/* Polymorphic inline cache code layout
+    0                                ---> no check type (marks a PIC)
+    pic
+    ld    [%o0], %g3                 ---> start of PIC
+  entry:
+    sethi %hi(dtable), %g4
+    or    %g4, %lo(dtable), %g4
+    cmp   %g3, %g4
+    bne   next entry
+    sethi %hi(entry), %g4
+    ld    [%g4+%lo(entry.count)], %g3    ---> only when hits are counted
+    add   %g3, 1, %g3                    --->
+    st    %g3, [%g4+%lo(entry.count)]    --->
+    ld    [%g4+%lo(entry.body)], %g4
+    jmp   %g4
+    nop
+    ...
+  unused entry:
+    ba,a  miss
+    ...
+  miss:
+    sethi %hi(extend_polymorphic_inline_cache), %g4
+    jmp   %g4+%lo(extend_polymorphic_inline_cache)
+    nop
+
+   The target is loaded from the entry, so that it can be changed by a
+   single store when the called method is retranslated. */
+#define  OFFSET_OF_PIC_CODE_START   2
+
+/* PICEntry
+   - a receiver type seen at the call site and the code called for it */
+typedef struct PICEntry_t {
+    Hjava_lang_Class*   type;
+    Method*             method;
+    void*               body;
+    int32               count;     /* number of hits */
+} PICEntry;
+
+/* PolymorphicInlineCache
+   - when a monomorphic inline cache misses, its call site is changed to
+   call this stub, which checks up to 'capacity' receiver types.  If all
+   of them miss, the stub is extended.  If it is full, the call site is
+   changed to 'ld/ld/jmpl' sequence.
+
+   The hits of each entry form the receiver type histogram of the call
+   site, which is used when the caller is retranslated.  They are counted
+   only in the code which is going to be retranslated. */
+typedef struct PolymorphicInlineCache_t {
+    int32                   capacity;
+    int32                   count;
+    bool                    countHits;
+    unsigned*               code;
+    PICEntry*               entries;
+    struct PolymorphicInlineCache_t* next;
+} PolymorphicInlineCache;
+
+/* maximum number of receiver types in a PIC. Less than 2 disables PICs. */
+extern int The_PIC_Max_Size;
+
+/* Return the PIC which the call instruction at 'call_site' calls,
+   or NULL if it does not call a PIC. */
+PolymorphicInlineCache* PIC_find_from_call_site(unsigned* call_site);
+
+/* Make a PIC out of a monomorphic inline cache and add an entry to it.
+   The call site is changed to call the PIC. */
+PolymorphicInlineCache* PIC_make_PIC(unsigned* call_site,
+                                     Hjava_lang_Class* type, Method* meth,
+                                     void* body);
+
+/* Add an entry to the PIC. Return false if it is full. */
+bool PIC_add_entry(PolymorphicInlineCache* pic, Hjava_lang_Class* type,
+                   Method* meth, void* body);
+
+/* Return the code for 'type' if it is already in the PIC. */
+void* PIC_find_body(PolymorphicInlineCache* pic, Hjava_lang_Class* type);
+
+/* Return the entry which takes most of the hits of the PIC, or NULL. */
+PICEntry* PIC_get_dominant_entry(PolymorphicInlineCache* pic);
+
+/* When a method is retranslated, entries whose bodies are equal to 'ocode'
+   have to be changed to 'ncode'. */
+void PIC_fixup_bodies(void* ocode, void* ncode);
+
+/* Change the call site to 'ld/ld/jmpl' sequence. */
+void PIC_make_ld_ld_jmpl_code(unsigned* call_site, int offset);
+
+#endif /* __PolymorphicInlineCache_h__ */
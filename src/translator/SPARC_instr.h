@@ -295,6 +295,12 @@ inline extern int get_opf_field( int instr_code )  { return instr_code & OPF_MAS
 // annul bit for branch operation
 #define  ANNUL_BIT  (1<<29)
 
+//
+// condition field of branch operation
+// Flipping its highest bit negates the condition, e.g. BE <-> BNE.
+#define  MASK_COND     (0xf << 25)
+#define  COND_NEGATE   (0x8 << 25)
+
 //
 // trap instructions
 //
@@ -373,6 +379,13 @@ inline extern int get_opf_field( int instr_code )  { return instr_code & OPF_MAS
 #define  FNEGS  (0x5 << 5 | 0x34 << 19 | 0x2 << 30)
 #define  FNEGD  (0x6 << 5 | 0x34 << 19 | 0x2 << 30)
 #define  FABSS  (0x9 << 5 | 0x34 << 19 | 0x2 << 30)
+#define  FABSD  (0xa << 5 | 0x34 << 19 | 0x2 << 30)
+
+//
+// floating-point square root instructions
+//
+#define  FSQRTS (0x029 << 5 | 0x34 << 19 | 0x2 << 30)
+#define  FSQRTD (0x02a << 5 | 0x34 << 19 | 0x2 << 30)
 
 //
 // floating-point add and subtract instructions
@@ -37,6 +37,7 @@ typedef struct SpecializedMethod_t {
     CallSiteInfo*       callSiteInfoTable; /* array[bpc] */
     int                 count;	        /* Method run count */
     int                 tr_level;	/* Number of retranslations done */
+    int                 backEdgeCount;	/* Loop iterations before OSR */
     void*               trampCode;
 #ifdef INLINE_CACHE
     struct TypeChecker_t*        tc;
@@ -55,6 +55,23 @@ check_nullpointer_eh(Method *method, constIndex idx)
     }
 }
 
+/* Name        : mark_block_start
+   Description : mark the start of a basic block which is profiled
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   	npc is the method entry, an exception handler, a branch target,
+   	or the fall-through path of a conditional branch.
+   Post-condition:
+   
+   Notes: light translations count the executions of these bytecodes.
+          see bytecode_profile.c */
+inline static
+void
+mark_block_start(int32 npc, int8 *binfo)
+{
+    binfo[npc] |= METHOD_BLOCK_START;
+}
+
 /* Name        : insert_excepion_handlers_into_tstack
    Description : inserts exception handlers into traverse stack so
                  that all bytecodes in the method can be traversed
@@ -90,6 +107,8 @@ insert_exception_handlers(Method *method, int *tstack, int tstack_top,
 
 	    check_nullpointer_eh(method, JEE_GetCatchIDX(entry));
 	
+	    // don't let a handler take the count of the block before it
+	    mark_block_start(handler_pc, binfo);
 	    tstack[++tstack_top] = handler_pc;
 	    visited[handler_pc] = true;
 	}
@@ -123,6 +142,23 @@ process_for_npc(Method *method, uint32 npc, int32 *tstack, int32 tstack_top,
     return tstack_top;
 }
 
+/* Name        : mark_loop_header
+   Description : mark the target of a backward branch as a loop header
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   	pc is a branch and npc is its taken target.
+   Post-condition:
+   
+   Notes: back-edge counters for on-stack replacement are put at loop
+          headers. */
+inline static
+void
+mark_loop_header(int32 pc, int32 npc, int8 *binfo)
+{
+    if (npc <= pc)
+	binfo[npc] |= METHOD_LOOP_HEADER;
+}
+
 /* Name        : BA_bytecode_analysis
    Description : traverses bytecodes and collect some informations
    Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
@@ -173,6 +209,7 @@ BA_bytecode_analysis(Method *method)
     /* The first instruction of method will be traversed. */
     tstack[++tstack_top] = 0;
     visited[0] = true;
+    mark_block_start(0, binfo);
 
     wide = false;
 
@@ -196,11 +233,14 @@ BA_bytecode_analysis(Method *method)
             //
             // for the fall-through path
             npc = pc + BCode_get_opcode_len(opcode);
+            mark_block_start(npc, binfo);
             tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					 visited, binfo);
 
             // for the taken path
             npc = pc + BCode_get_int16(bcodes + pc + 1);
+            mark_loop_header(pc, npc, binfo);
+            mark_block_start(npc, binfo);
             tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					 visited, binfo);
 
@@ -213,12 +253,16 @@ BA_bytecode_analysis(Method *method)
 
           case GOTO:
             npc = pc + BCode_get_int16(bcodes + pc + 1);
+            mark_loop_header(pc, npc, binfo);
+            mark_block_start(npc, binfo);
             tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					 visited, binfo);
             break;
 
           case GOTO_W:
             npc = pc + BCode_get_int32(bcodes + pc + 1);
+            mark_loop_header(pc, npc, binfo);
+            mark_block_start(npc, binfo);
             tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					 visited, binfo);
             break;
@@ -258,11 +302,13 @@ BA_bytecode_analysis(Method *method)
                 BCode_get_int32(bcodes + addr + 4) + 1;
             for (; i > 0; i--) {
                 npc = pc + BCode_get_int32(bcodes + addr + 8 + i * 4);
+                mark_block_start(npc, binfo);
                 tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					     visited, binfo);
             }
 
             npc = pc + BCode_get_int32(bcodes + addr);
+            mark_block_start(npc, binfo);
             tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					 visited, binfo);
             break;
@@ -273,10 +319,12 @@ BA_bytecode_analysis(Method *method)
             i = BCode_get_int32(bcodes + addr + 4);
             for (; i > 0; i--) {
                 npc = pc + BCode_get_int32(bcodes + addr + 4 + i * 8);
+                mark_block_start(npc, binfo);
                 tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					     visited, binfo);
             }
             npc = pc + BCode_get_int32(bcodes + addr);
+            mark_block_start(npc, binfo);
             tstack_top = process_for_npc(method, npc, tstack, tstack_top,
 					 visited, binfo);
             break;
@@ -11,11 +11,150 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
+#include <assert.h>
 #include "config.h"
+#include "gc.h"
 #include "bytecode.h"
 #include "bytecode_profile.h"
 
 
+#ifdef METHOD_COUNT
+//////////////////////////////////////////////////////////////////////
+//  basic block profile
+//
+//  Light translations increment a counter at the start of each basic
+//  block (see CSeq_create_block_count_code()), and another one after
+//  the prologue, which counts invocations.  The block at bytecode 0
+//  can't be used for the latter, since it may be a loop header.  The
+//  counters are kept per method and survive retranslations, so that
+//  the final translation can use them for inlining and code placement.
+//////////////////////////////////////////////////////////////////////
+
+/* a block is hot if it runs this many times per method invocation */
+#define Pbc_HOT_BLOCK_RATIO 2
+
+
+/* Name        : Pbc_init_block_profile
+   Description : allocate basic block counters of a method
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+       bytecode analysis has been done for the method
+   Post-condition:
+   
+   Notes: counters are indexed by bytecode pc.  only those of
+          METHOD_BLOCK_START bytecodes are used. */
+void
+Pbc_init_block_profile(Method *method)
+{
+    int len;
+
+    if (method->blockCounts != NULL)
+      return;
+
+    len = Method_GetByteCodeLen(method);
+    method->blockCounts = (uint32 *) gc_malloc_fixed(sizeof(uint32) * len);
+    bzero(method->blockCounts, sizeof(uint32) * len);
+}
+
+/* Name        : Pbc_get_block_counter
+   Description : get the address of a basic block counter
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+       Pbc_init_block_profile() has been called for the method
+   Post-condition:
+   
+   Notes:  */
+uint32 *
+Pbc_get_block_counter(Method *method, int bpc)
+{
+    assert(method->blockCounts != NULL);
+    assert(Method_GetBcodeInfo(method)[bpc] & METHOD_BLOCK_START);
+
+    return &method->blockCounts[bpc];
+}
+
+/* Name        : Pbc_get_entry_counter
+   Description : get the address of the invocation counter
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+       Pbc_init_block_profile() has been called for the method
+   Post-condition:
+   
+   Notes: incremented only when entering through the prologue, not
+          by OSR entries or exception handlers. */
+uint32 *
+Pbc_get_entry_counter(Method *method)
+{
+    assert(method->blockCounts != NULL);
+
+    return &method->entryCount;
+}
+
+/* Name        : Pbc_get_block_count
+   Description : get the run count of the basic block starting at bpc
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   
+   Post-condition:
+   
+   Notes: -1 if the method has not run in a light translation yet,
+          or bpc is not the start of a profiled block. */
+int
+Pbc_get_block_count(Method *method, int bpc)
+{
+    uint8 *binfo = Method_GetBcodeInfo(method);
+
+    if (method->blockCounts == NULL || method->entryCount == 0
+        || bpc < 0 || bpc >= Method_GetByteCodeLen(method)
+        || !(binfo[bpc] & METHOD_BLOCK_START))
+      return -1;
+
+    return (int) method->blockCounts[bpc];
+}
+
+/* Name        : Pbc_get_frequency
+   Description : classify how often the bytecode at bpc runs per method
+                 invocation
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   
+   Post-condition:
+   
+   Notes: The count of the nearest block start before bpc is used.
+          Block starts are marked at all branch targets and exception
+          handlers, so no other block can be in between. */
+BlockFrequency
+Pbc_get_frequency(Method *method, int bpc)
+{
+    uint8 *binfo = Method_GetBcodeInfo(method);
+    int entry_count;
+    int count;
+
+    if (method->blockCounts == NULL || method->entryCount == 0
+        || bpc < 0 || bpc >= Method_GetByteCodeLen(method))
+      return PBC_UNKNOWN;
+
+    while (!(binfo[bpc] & METHOD_BLOCK_START))
+      bpc--;
+
+    entry_count = (int) method->entryCount;
+    count = (int) method->blockCounts[bpc];
+
+    if (count == 0)
+      return PBC_COLD;
+    if (count >= entry_count * Pbc_HOT_BLOCK_RATIO)
+      return PBC_HOT;
+
+    return PBC_WARM;
+}
+#endif /* METHOD_COUNT */
+
+
+#ifdef BYTECODE_PROFILE
+//////////////////////////////////////////////////////////////////////
+//  bytecode profile for debugging
+//////////////////////////////////////////////////////////////////////
+
 typedef struct BytecodeProfile {
     Method *method;
     unsigned int bytecodeLen;
@@ -241,3 +380,4 @@ Pbc_sort_profile()
         }
     }
 }
+#endif /* BYTECODE_PROFILE */
@@ -14,9 +14,27 @@
 #include "classMethod.h"
 // #include "gtypes.h"
 
+#ifdef METHOD_COUNT
+/* how often a basic block runs per method invocation */
+typedef enum {
+    PBC_UNKNOWN,		/* not profiled */
+    PBC_COLD,			/* never run */
+    PBC_WARM,
+    PBC_HOT			/* runs several times per invocation */
+} BlockFrequency;
+
+void Pbc_init_block_profile(Method *method);
+uint32 *Pbc_get_block_counter(Method *method, int bpc);
+uint32 *Pbc_get_entry_counter(Method *method);
+int Pbc_get_block_count(Method *method, int bpc);
+BlockFrequency Pbc_get_frequency(Method *method, int bpc);
+#endif /* METHOD_COUNT */
+
+#ifdef BYTECODE_PROFILE
 void Pbc_init_profile(Method *method);
 void Pbc_increase_frequency(Method *method, int bpc);
 void Pbc_print_profile();
+#endif /* BYTECODE_PROFILE */
 
 #endif // __bytecode_profile_h__
 
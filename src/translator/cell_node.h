@@ -39,6 +39,7 @@ typedef struct CellNode {
 
 void CN_initialize(void);
 void CN_register_data(uintp start_addr , uintp end_addr , void *data, Origin org);
+void CN_deregister_data(uintp start_addr , uintp end_addr , void *data);
 
 void *CN_find_data(uintp addr);
 bool CN_is_from_type_check_code(uintp pc);
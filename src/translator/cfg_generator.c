@@ -36,9 +36,7 @@
 #include "TypedValue.h"
 #endif /* TYPE_ANALYSIS */
 
-#ifdef BYTECODE_PROFILE
 #include "bytecode_profile.h"
-#endif
 
 #define DBG(s) 
 #define FDBG(s)    
@@ -51,6 +49,8 @@
    bytecodes */
 /* currently inlining graph node */
 InlineGraph *CFGGen_current_ig_node;	
+/* whether the translation is for exception handlers or OSR entries */
+bool CFGGen_from_exception;
 static InstrNode **translated_instrs;	/* instruction arrray */
 static int *ops_types;	/* operand stack type array */
 
@@ -183,6 +183,36 @@ is_bytecode_join(uint8 *binfo, InstrOffset pc)
     return binfo[pc] & METHOD_JOIN_POINT;
 }
 
+/* Name        : is_bytecode_loop_header
+   Description : Check if this bytecode is the target of a back edge
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   
+   Post-condition:
+   
+   Notes:  */
+inline static
+bool
+is_bytecode_loop_header(uint8 *binfo, InstrOffset pc)
+{
+    return binfo[pc] & METHOD_LOOP_HEADER;
+}
+
+
+/* Name        : is_bytecode_block_start
+   Description : Check if this bytecode starts a profiled basic block
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   
+   Post-condition:
+   
+   Notes:  */
+inline static
+bool
+is_bytecode_block_start(uint8 *binfo, InstrOffset pc)
+{
+    return binfo[pc] & METHOD_BLOCK_START;
+}
 
 /* Name        : CFGGen_process_for_branch
    Description : handle branch instruction
@@ -917,8 +947,35 @@ translate_main_flow(CFG* cfg, TranslationInfo *info, InlineGraph *graph)
     int start_pc;
     uint8 opcode;
     Method *method;
+#ifdef METHOD_COUNT
+    uint8 *binfo;
+    bool count_back_edges;
+    bool count_blocks;
+#endif /* METHOD_COUNT */
     
     method = IG_GetMethod(graph);
+
+#ifdef METHOD_COUNT
+    binfo = Method_GetBcodeInfo(method);
+
+    // Loop headers of light translations count the iterations, so
+    // that long running loops can be replaced on stack.
+    count_back_edges = (flag_osr
+                        && info != NULL
+                        && IG_GetDepth(graph) == 0
+                        && !TI_IsFromException(info)
+                        && The_Need_Retranslation_Flag);
+
+    // Basic blocks of light translations are counted, so that the
+    // retranslation knows which paths are hot.
+    count_blocks = (flag_block_profile
+                    && info != NULL
+                    && IG_GetDepth(graph) == 0
+                    && !TI_IsFromException(info)
+                    && The_Need_Retranslation_Flag);
+    if (count_blocks)
+      Pbc_init_block_profile(method);
+#endif /* METHOD_COUNT */
     
     //
     // create some prologue code of function First, the new register
@@ -930,7 +987,11 @@ translate_main_flow(CFG* cfg, TranslationInfo *info, InlineGraph *graph)
     // obtained.
     //
     if (IG_GetDepth(graph) == 0) {
-        if (TI_IsFromException(info)) {
+        if (TI_IsOSREntry(info)) {
+            last_instr = CSeq_create_osr_prologue_code(cfg, graph);
+
+            ops_top = -1;
+        } else if (TI_IsFromException(info)) {
 	    
             last_instr = CSeq_create_exception_handler_prologue_code(cfg,
 								     graph);
@@ -939,6 +1000,12 @@ translate_main_flow(CFG* cfg, TranslationInfo *info, InlineGraph *graph)
 	    ops_top = 0;
         } else {
             last_instr = CSeq_create_function_prologue_code(cfg, graph);
+#ifdef METHOD_COUNT
+            if (count_blocks)
+              last_instr =
+                  CSeq_create_block_count_code(cfg, last_instr, 0, NULL,
+                                               Pbc_get_entry_counter(method));
+#endif /* METHOD_COUNT */
         }
     } else {
         last_instr = CSeq_create_inline_prologue_code(cfg, graph);
@@ -973,6 +1040,50 @@ translate_main_flow(CFG* cfg, TranslationInfo *info, InlineGraph *graph)
 
             opcode = BCode_get_uint8(Method_GetByteCode(method) + next_pc);
 
+#ifdef METHOD_COUNT
+            if ((count_blocks && is_bytecode_block_start(binfo, next_pc))
+                || (count_back_edges
+                    && is_bytecode_loop_header(binfo, next_pc)
+                    && ops_top == -1)) {
+                InstrNode *first_instr = NULL;
+                InstrNode *count_instr;
+                int header_pc = next_pc;
+
+                if (count_blocks
+                    && is_bytecode_block_start(binfo, header_pc)) {
+                    last_instr =
+                        CSeq_create_block_count_code(cfg, last_instr,
+                                                     header_pc, &first_instr,
+                                                     Pbc_get_block_counter(method, header_pc));
+                }
+
+                if (count_back_edges
+                    && is_bytecode_loop_header(binfo, header_pc)
+                    && ops_top == -1) {
+                    last_instr =
+                        CSeq_create_back_edge_count_code(cfg, last_instr,
+                                                         header_pc, &count_instr,
+#ifdef CUSTOMIZATION
+                                                         TI_GetSM(info),
+                                                         &TI_GetSM(info)->backEdgeCount
+#else
+                                                         method,
+                                                         &method->backEdgeCount
+#endif
+                                                         );
+                    if (first_instr == NULL)
+                      first_instr = count_instr;
+                }
+
+                translate_bytecode(opcode, cfg, method, header_pc,
+                                   last_instr);
+
+                // branches to the block go through the counters
+                translated_instrs[header_pc] = first_instr;
+                continue;
+            }
+#endif /* METHOD_COUNT */
+
             //
             // now the code traslation is really done here.
             // The successors are push onto stack in here and
@@ -1148,20 +1259,27 @@ determine_compilation_flags(Method* meth, TranslationInfo *info)
 #endif;
     // if (translator is called from exception)
     //   all optimizations are determined by user-defined options, but,
-    //   method inlining is disabled.
+    //   method inlining is disabled.  This includes entries for
+    //   on-stack replacement, which are translated like handlers, so
+    //   calls in a hot loop entered through OSR are not inlined until
+    //   the method is retranslated on its next invocation.
     // else if (adaptive compilation turned off 
     //         || this method is retranslated 
     //         || the method has no unresolved call site)
     //   all optimizations including method inlining are determined by
     //   user-defined options
     // else -> initial translation
-    //   all optimizations included method inlining are disabled.
+    //   all optimizations included method inlining are disabled,
+    //   and the backward sweep of register allocation is skipped
+    //   unless -nolightregalloc is given.
     from_exception = TI_IsFromException(info);
+    CFGGen_from_exception = from_exception;
 
     if (from_exception) {
         The_Final_Translation_Flag = true;
         flag_no_regionopt = !The_Use_Regionopt_Option;
         flag_no_loopopt = !The_Use_Loopopt_Option;
+        flag_no_backward_sweep = !The_Use_Backward_Sweep_Option;
 #ifdef HANDLER_INLINE
         flag_inlining = The_Use_Method_Inline_Option;
         flag_type_analysis = The_Use_TypeAnalysis_Flag;
@@ -1176,6 +1294,7 @@ determine_compilation_flags(Method* meth, TranslationInfo *info)
         flag_no_regionopt = !The_Use_Regionopt_Option;
         flag_inlining = The_Use_Method_Inline_Option;
         flag_no_loopopt = !The_Use_Loopopt_Option;
+        flag_no_backward_sweep = !The_Use_Backward_Sweep_Option;
         
         // If the method has only resolved call sites or
         // is compiled to general version, then
@@ -1189,6 +1308,10 @@ determine_compilation_flags(Method* meth, TranslationInfo *info)
         flag_inlining = false;
         flag_no_loopopt = true;
         flag_type_analysis = false;
+        // The light translation is replaced when the method gets hot,
+        // so registers are allocated by forward sweeps only.
+        flag_no_backward_sweep = (!The_Use_Backward_Sweep_Option
+                                  || !flag_no_light_regalloc);
     }
 
     The_Need_Retranslation_Flag = !The_Final_Translation_Flag;
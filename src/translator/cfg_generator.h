@@ -87,6 +87,8 @@ struct CFG;
 enum ReturnType;
 
 extern struct InlineGraph *CFGGen_current_ig_node;
+/* whether the method being translated is entered from an exception */
+extern bool CFGGen_from_exception;
 
 struct CFG *CFGGen_generate_CFG(struct TranslationInfo *info);
 
@@ -38,6 +38,7 @@
 #endif
 #ifdef METHOD_COUNT
 #include "retranslate.h"
+#include "bytecode_profile.h"
 #endif
 #ifdef DYNAMIC_CHA
 #include "dynamic_cha.h"
@@ -54,6 +55,16 @@ static const int BlockSize = 32;
 
 
 
+#ifdef DYNAMIC_CHA
+// whether the cfg has a speculatively inlined method
+static bool has_speculative_inlining;
+
+// the translation which depends on the speculatively inlined methods,
+// and its entry to overwrite when it is deoptimized
+static void *deopt_owner;
+static nativecode *deopt_entry;
+#endif
+
 #define DBG(s)   
 #define EDBG(s)
 #define PDBG(s)	
@@ -339,7 +350,7 @@ CodeGen_fill_delay_slot(CFG* cfg, InstrNode* instr)
     } else if (Instr_IsBranch(instr)) {
 #ifdef DYNAMIC_CHA
         if (Instr_GetCode(instr) == SPEC_INLINE)
-          ; // do nothing
+          has_speculative_inlining = true;
         else
 #endif
 
@@ -467,6 +478,86 @@ CodeGen_update_cfg(CFG* cfg)
 }
 
 
+#ifdef METHOD_COUNT
+///
+/// Function Name : CodeGen_get_block_count
+/// Author : Yang, Byung-Sun
+/// Input
+///     header - the first instruction of a basic block
+/// Output
+///     How many times the block ran in the light translation.
+///     -1 if it is not known.
+/// Pre-Condition
+/// Post-Condition
+/// Description
+///     The count is only known if the header is the first
+///     instruction of a profiled bytecode block.
+///
+static
+int
+CodeGen_get_block_count(InstrNode* header)
+{
+    InlineGraph* graph = Instr_GetInlineGraph(header);
+
+    if (graph == NULL) {
+        return -1;
+    }
+
+    return Pbc_get_block_count(IG_GetMethod(graph),
+                               Instr_GetBytecodePC(header));
+}
+
+///
+/// Function Name : CodeGen_lay_out_hot_paths
+/// Author : Yang, Byung-Sun
+/// Input
+///     cfg - control flow graph of register allocated code
+/// Output
+/// Pre-Condition
+///     The delay slots are not filled yet.
+/// Post-Condition
+/// Description
+///     The fall-through path of a conditional branch is placed right
+///     after the branch. If the taken path ran more often in the light
+///     translation, the condition is negated so that the hot path falls
+///     through.
+///
+static
+void
+_CodeGen_lay_out_hot_paths(CFG* cfg, InstrNode* instr)
+{
+    int          i;
+
+    if (Instr_IsVisited(instr)) {
+        return;
+    }
+
+    Instr_MarkVisited(instr);
+
+    if (Instr_IsCondBranch(instr) && Instr_GetNumOfSuccs(instr) == 2) {
+        int   fall_count = CodeGen_get_block_count(Instr_GetSucc(instr, 0));
+        int   taken_count = CodeGen_get_block_count(Instr_GetSucc(instr, 1));
+
+        if (fall_count >= 0 && taken_count > fall_count) {
+            Instr_NegateBranch(instr);
+        }
+    }
+
+    for (i = 0; i < Instr_GetNumOfSuccs(instr); i++) {
+        _CodeGen_lay_out_hot_paths(cfg, Instr_GetSucc(instr, i));
+    }
+}
+
+static
+void
+CodeGen_lay_out_hot_paths(CFG* cfg)
+{
+    CFG_PrepareTraversal(cfg);
+    _CodeGen_lay_out_hot_paths(cfg, cfg->root);
+}
+#endif /* METHOD_COUNT */
+
+
 ///
 /// Function Name : CodeGen_position_basic_blocks
 /// Author : Yang, Byung-Sun
@@ -498,6 +589,8 @@ CodeGen_update_cfg(CFG* cfg)
 ///     at the end of the method. In order for this, exceptional_headers
 ///     is recorded. LaTTe considers the basic blocks listed in
 ///     "exceptional_headers" after those in "bb_headers".
+///     Blocks which never ran in the light translation, such as the
+///     paths throwing exceptions, are also placed there.
 ///
 
 static int         max_num_of_bb;    // maximum number of basic blocks
@@ -546,6 +639,16 @@ CodeGen_is_exceptional_header(CFG* cfg, InstrNode* header)
         return 1;
     }
 
+#ifdef METHOD_COUNT
+    // The blocks which never ran before the retranslation are cold.
+    if (header != cfg->root &&
+         Instr_GetCode(header) != DUMMY_OP &&
+         num_of_ebh < MAX_NUM_OF_EXCEPTIONAL_HEADERS &&
+         CodeGen_get_block_count(header) == 0) {
+        return 1;
+    }
+#endif
+
     return 0;
 }
 #endif // OUTLINING
@@ -1182,6 +1285,9 @@ CodeGen_fill_text_segment(InstrNode* instr, uint* text_seg)
         DCHA_add_speculative_call_site((Method*)instr->dchaInfo, 
                     (uint32*)(text_seg + Instr_GetNativeOffset(instr)),
                     instr->fields.format_3.disp22<<2, DCHA_SPEC_INLINE);
+        DCHA_add_dependent_code((Method*)instr->dchaInfo,
+                                IG_GetMI(CFG_get_IG_root(cfg)),
+                                deopt_owner, deopt_entry);
     } else
 #endif
     if (Instr_GetCode(instr) != DUMMY_OP)
@@ -1376,13 +1482,33 @@ CodeGen_generate_code(TranslationInfo *info)
     byte *data_seg;
     InlineGraph *root = CFG_get_IG_root(cfg);
     MethodInstance *instance = IG_GetMI(root);
+    bool need_deopt_entry = false;
     method = IG_GetMethod(root);
 
     assert(cfg);
 
+#ifdef DYNAMIC_CHA
+    has_speculative_inlining = false;
+    deopt_owner = NULL;
+    deopt_entry = NULL;
+#endif
+
+#ifdef METHOD_COUNT
+    if (!The_Need_Retranslation_Flag) {
+        CodeGen_lay_out_hot_paths(cfg);
+    }
+#endif
 
     CodeGen_update_cfg(cfg);
 
+#if defined(DYNAMIC_CHA) && defined(METHOD_COUNT)
+    // The count code of a light translation is also its entry for
+    // deoptimization.  Final translations get a space of the same size.
+    need_deopt_entry = (has_speculative_inlining && flag_deopt
+                        && !The_Need_Retranslation_Flag
+                        && !TI_IsFromException(info));
+#endif
+
     allocate_recording_map_pool(cfg);
 
     if (TI_IsFromException(info) == false) {
@@ -1391,7 +1517,13 @@ CodeGen_generate_code(TranslationInfo *info)
         CodeGen_set_stack_size(cfg);
     } else {
 //          CodeGen_remove_dummy_root(cfg);
+
+        /* The code runs in the frame of the method it is entered
+           from.  The size is only recorded so that the caller can
+           check if that frame is large enough. */
+        CodeGen_calculate_stack_size(cfg);
     }
+    TI_SetFrameSize(info, CFG_GetStackSize(cfg));
 
 #ifdef NEW_COUNT_RISC
     CodeGen_insert_profile_code(cfg);
@@ -1422,7 +1554,7 @@ CodeGen_generate_code(TranslationInfo *info)
 
     if (TI_IsFromException(info) == false) {
         text_seg_size = CFG_GetTextSegSize(cfg) + PROLOGUE_CODE_SIZE;
-        if (The_Need_Retranslation_Flag)
+        if (The_Need_Retranslation_Flag || need_deopt_entry)
           text_seg_size += COUNT_CODE_SIZE;
     } else {
         text_seg_size = CFG_GetTextSegSize(cfg);
@@ -1439,13 +1571,14 @@ CodeGen_generate_code(TranslationInfo *info)
        2. whether separate text segment and data segment */
 #ifdef USE_CODE_ALLOCATOR
 #ifdef SPLIT_TEXT_DATA
-    if (The_Final_Translation_Flag)
-      text_seg = (byte *) CMA_allocate_code_block(text_seg_size );
-    else
-      text_seg = (byte *) (((int) gc_malloc_fixed(text_seg_size + BlockSize)
-                              + BlockSize - 1) & (- BlockSize));
+    /* Light translations are also put in the code heap, since their
+       bodies are given back to it after retranslation. */
+    text_seg = (byte *) CMA_allocate_code_block(text_seg_size );
 
     data_seg = (byte *) gc_malloc_fixed(data_seg_size);
+
+    MI_SetSegments(instance, text_seg, text_seg_size, data_seg,
+                   recording_map_pool);
 #else
     text_seg = (byte *) allocate_code_block(text_seg_size + data_seg_size
                                              + BlockSize * 2);
@@ -1468,11 +1601,19 @@ CodeGen_generate_code(TranslationInfo *info)
 
 #endif // USE_CODE_ALLOCATOR
 
+#if !defined(USE_CODE_ALLOCATOR) || !defined(SPLIT_TEXT_DATA)
+    /* only the variable maps can be freed separately */
+    MI_SetSegments(instance, NULL, 0, NULL, recording_map_pool);
+#endif
 
 
     assert(((int) text_seg % 8) == 0 && ((int) data_seg % 8) == 0);
 
     MI_SetLaTTeTranslated(instance);
+#ifdef METHOD_COUNT
+    if (The_Need_Retranslation_Flag)
+      MI_SetLightTranslated(instance);
+#endif
 
     assert(cfg->maxNumOfArgs >= 6);
 
@@ -1507,11 +1648,25 @@ PDBG(num_of_risc_instr = 0;)
         }
 
         TC_MakeHeader(tc, method, (unsigned*)text_seg);
+#ifdef DYNAMIC_CHA
+        deopt_owner = sm;
+#endif
         if (The_Need_Retranslation_Flag) {
+#ifdef DYNAMIC_CHA
+            deopt_entry = text_seg_start;
+#endif
             generate_count_code(TI_GetSM(info), (unsigned*)text_seg_start, 
                                 (unsigned*)(text_seg_start+COUNT_CODE_SIZE));
             text_seg_start += COUNT_CODE_SIZE;
         }
+#if defined(DYNAMIC_CHA) && defined(METHOD_COUNT)
+        else if (need_deopt_entry) {
+            deopt_entry = text_seg_start;
+            DCHA_make_deoptimizable_entry((unsigned*)text_seg_start,
+                                (unsigned*)(text_seg_start+COUNT_CODE_SIZE));
+            text_seg_start += COUNT_CODE_SIZE;
+        }
+#endif
 #else /* not CUSTOMIZATION */
         Hjava_lang_Class *checkType = TI_GetCheckType(info);
         TypeChecker* tc;
@@ -1526,11 +1681,25 @@ PDBG(num_of_risc_instr = 0;)
 
         tc = TC_make_TypeChecker(method, checkType, text_seg_start);
         TC_MakeHeader(tc, method, (unsigned*)text_seg);
+#ifdef DYNAMIC_CHA
+        deopt_owner = method;
+#endif
         if (The_Need_Retranslation_Flag) {
+#ifdef DYNAMIC_CHA
+            deopt_entry = text_seg_start;
+#endif
             generate_count_code(method, text_seg_start, 
                                 text_seg_start+COUNT_CODE_SIZE);
             text_seg_start += COUNT_CODE_SIZE;
         }
+#if defined(DYNAMIC_CHA) && defined(METHOD_COUNT)
+        else if (need_deopt_entry) {
+            deopt_entry = text_seg_start;
+            DCHA_make_deoptimizable_entry((unsigned*)text_seg_start,
+                                (unsigned*)(text_seg_start+COUNT_CODE_SIZE));
+            text_seg_start += COUNT_CODE_SIZE;
+        }
+#endif
 #endif /* not CUSTOMIZATION */
     } else {
         text_seg_start = text_seg;
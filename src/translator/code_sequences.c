@@ -8,6 +8,7 @@
    
    See the file LICENSE for usage and redistribution terms and a
    disclaimer of all warranties. */
+#include <string.h>
 #include "classMethod.h"
 #include "SPARC_instr.h"
 #include "CFG.h"
@@ -21,13 +22,18 @@
 #include "class_inclusion_test.h"
 #include "translator_driver.h"
 #include "stat.h"
+#include "code_sequences.h"
 #include "functions.h"
 #include "bytecode.h"
+#include "exception_handler.h"
+#include "flags.h"
+#include "gc.h"
+#include "object.h"
 #ifdef TYPE_ANALYSIS
 #include "TypeAnalysis.h"
 #endif
 
-#ifdef BYTECODE_PROFILE
+#if defined(BYTECODE_PROFILE) || defined(METHOD_COUNT)
 #include "bytecode_profile.h"
 #endif
 
@@ -712,6 +718,32 @@ CSeq_create_exception_handler_prologue_code(CFG *cfg, InlineGraph *graph)
     return c_instr;
 }
 
+/* Name        : CSeq_create_osr_prologue_code
+   Description : create the prologue of an entry for on-stack
+                 replacement
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   
+   Post-condition:
+   
+   Notes: same as the exception handler prologue, but there is no
+          exception object to push.  */
+InstrNode *
+CSeq_create_osr_prologue_code(CFG *cfg, InlineGraph *graph)
+{
+    InstrNode *c_instr = NULL;
+
+    // This is a dummy root for the entry
+    c_instr = create_format1_instruction(DUMMY_OP, 0, -3);
+    CFG_SetRoot(cfg, c_instr);
+    CFG_RegisterInstr(cfg, c_instr);
+
+    IG_SetHead(graph, c_instr);
+    CFG_MarkExceptionGeneratableInstr(cfg, c_instr);
+
+    return c_instr;
+}
+
 /* Name        : CSeq_create_inline_prologue_code
    Description : create inlining prologue codes
    Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
@@ -1098,7 +1130,8 @@ CSeq_create_array_bound_checking_code(CFG *cfg, InstrNode *p_instr,
    Post-condition:
    
    Notes: If first_instr is not null, first_instr is set to first
-          instruction of checking code */
+          instruction of checking code.  Component types which have
+          no id in the display are checked by RT_check_array_store(). */
 InstrNode *
 CSeq_create_array_store_checking_code(CFG *cfg, InstrNode *p_instr,
 				      int pc, InstrNode **first_instr,
@@ -1108,17 +1141,25 @@ CSeq_create_array_store_checking_code(CFG *cfg, InstrNode *p_instr,
     //    add    rt1, rs{array_ref_index}, g0
     //    subcc  rt0, 0, g0
     //    be     FINISH
+    //    ld     [rt1+ARRAY_ENCODINGOFFSET], it2  // id of component type
+    //    subcc  it2, 0, g0
+    //    be     SLOW
     // NORMAL:
+    //    add    g0, rt1, g0      <- nop to indicate rt1 is dead.
     //    ld     [rt0], rt3       //load dtable
-    //    ld     [rt1+ARRAY_ENCODINGOFFSET], it2
-    //    ld     [rt3+DTABLE_ROWOFFSET], rt4
-    //    srl    it2, 8, it5      // (pos >> 3)
-    //    ldub   [rt4, it5], it6  // (0x1 << (7-(pos & 0x7)))
-    //    andcc  it6, it2, g0
-    //    te    0x14
+    //    ld     [rt3+DTABLE_DISPLAYOFFSET], rt4
+    //    srl    it2, TYPE_ID_OFFSETSHIFT, it5
+    //    ld     [rt4+it5], it6
+    //    subcc  it6, it2, g0
+    //    tne    0x13
     // FINISH:
     //    NOP
-    InstrNode *c_instr, *branch_instr, *end_instr;
+    // SLOW:
+    //    add    g0, it2, g0      <- nop to indicate it2 is dead.
+    //    call   RT_check_array_store (o0: rt1, o1: rt0)
+    //    goto   FINISH
+    InstrNode *c_instr, *branch_instr1, *branch_instr2, *end_instr;
+    int arg_vars[2];
 
     c_instr = p_instr;
 
@@ -1128,32 +1169,53 @@ CSeq_create_array_store_checking_code(CFG *cfg, InstrNode *p_instr,
 
     APPEND_INSTR5(SUBCC, g0, RT(0), 0);
     APPEND_INSTR3(BE);
-    branch_instr = c_instr;
-    CFGGen_process_for_branch(cfg, branch_instr);
+    branch_instr1 = c_instr;
+    CFGGen_process_for_branch(cfg, branch_instr1);
+
+    APPEND_INSTR5(LD, IT(2), RT(1), ARRAY_ENCODINGOFFSET);
+    APPEND_INSTR5(SUBCC, g0, IT(2), 0);
+    APPEND_INSTR3(BE);
+    branch_instr2 = c_instr;
+    CFGGen_process_for_branch(cfg, branch_instr2);
 
     // NORMAL
-    APPEND_INSTR5(LD, RT(3), RT(0), 0);       // get dtable pointer
+    APPEND_INSTR6(ADD, g0, RT(1), g0);
     Instr_SetLastUseOfSrc(c_instr, 0);
-    APPEND_INSTR5(LD, IT(2), RT(1), ARRAY_ENCODINGOFFSET);
+    APPEND_INSTR5(LD, RT(3), RT(0), 0);       // get dtable pointer
     Instr_SetLastUseOfSrc(c_instr, 0);
-    APPEND_INSTR5(LD, RT(4), RT(3), DTABLE_ROWOFFSET); //get row array
+    APPEND_INSTR5(LD, RT(4), RT(3), DTABLE_DISPLAYOFFSET); //get display
     Instr_SetLastUseOfSrc(c_instr, 0);
 
-    APPEND_INSTR5(SRL, IT(5), IT(2), 8);      // (pos >> 3)
-    APPEND_INSTR4(LDUB, IT(6), RT(4), IT(5));
+    APPEND_INSTR5(SRL, IT(5), IT(2), TYPE_ID_OFFSETSHIFT);
+    APPEND_INSTR4(LD, IT(6), RT(4), IT(5));
     Instr_SetLastUseOfSrc(c_instr, 0);
     Instr_SetLastUseOfSrc(c_instr, 1);
 
-    APPEND_INSTR6(ANDCC, g0, IT(6), IT(2));
+    APPEND_INSTR6(SUBCC, g0, IT(6), IT(2));
     Instr_SetLastUseOfSrc(c_instr, 0);
     Instr_SetLastUseOfSrc(c_instr, 1);
-    APPEND_INSTR9(TE, 0x14);
+    APPEND_INSTR9(TNE, 0x13);
     CFG_MarkExceptionGeneratableInstr(cfg, c_instr);
 
     //FINISH
     APPEND_NOP();
     end_instr = c_instr;
-    Instr_connect_instruction (branch_instr, end_instr);
+    Instr_connect_instruction (branch_instr1, end_instr);
+
+    // SLOW
+    c_instr = branch_instr2;
+    APPEND_INSTR6(ADD, g0, IT(2), g0);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR1(CALL, (int) RT_check_array_store);
+
+    arg_vars[0] = RT(1);
+    arg_vars[1] = RT(0);
+
+    CFGGen_process_for_function_call(cfg, c_instr, RT_check_array_store,
+                                     2, arg_vars, 0, NULL);
+    CFG_MarkExceptionGeneratableInstr(cfg, c_instr);
+    Instr_connect_instruction(c_instr, end_instr);
+
     c_instr = end_instr;
 
     return c_instr;
@@ -1342,6 +1404,506 @@ CSeq_create_process_class_code(CFG *cfg, InstrNode *p_instr, int pc,
     return last_instr;
 }
 
+#ifdef METHOD_COUNT
+/* Name        : CSeq_create_back_edge_count_code
+   Description : create the back-edge counter put at a loop header of
+                 lightly translated code
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       counter is a field of owner, which is passed to
+       EH_transfer_to_osr_code().  the operand stack is empty.
+   Post-condition:
+   
+   Notes: the call is marked as exception generatable, so that the
+          variable map at the call is recorded in the exception
+          information table.  on-stack replacement uses the map to
+          transfer live variables.  */
+InstrNode *
+CSeq_create_back_edge_count_code(CFG *cfg, InstrNode *p_instr, int pc,
+				 InstrNode **first_instr,
+				 void *owner, int *counter)
+{
+    //
+    //    sethi  %hi(owner), rt0
+    //    or     rt0, %lo(owner), rt1
+    //    ld     [rt1+offset_of_counter], it2
+    //    sub    it2, 1, it3
+    //    st     it3, [rt1+offset_of_counter]
+    //    subcc  it3, 0, g0
+    //    ble    OSR
+    //  NORMAL:
+    //    add    rt1, g0, g0     <- nop to indicate rt1 is last used.
+    //    .....
+    //
+    //  OSR:
+    //    mov    rt1, rt4
+    //    call   EH_transfer_to_osr_code (o0: rt4, ret: void)
+    //
+    InstrNode *c_instr = p_instr;
+    InstrNode *branch_instr;
+    InstrNode *join_instr;
+
+    int arg_vars[1];
+
+    int offset_of_counter = ((char *) counter) - ((char *) owner);
+
+    APPEND_INSTR2(SETHI, RT(0), HI(owner));
+    if (first_instr != NULL) *first_instr = c_instr;
+    APPEND_INSTR5(OR, RT(1), RT(0), LO(owner));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR5(LD, IT(2), RT(1), offset_of_counter);
+    APPEND_INSTR5(SUB, IT(3), IT(2), 1);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR8(ST, IT(3), RT(1), offset_of_counter);
+
+    APPEND_INSTR5(SUBCC, g0, IT(3), 0);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR3(BLE);
+    branch_instr = c_instr;
+    CFGGen_process_for_branch(cfg, branch_instr);
+
+    APPEND_INSTR6(ADD, g0, RT(1), g0);
+    join_instr = c_instr;
+    Instr_SetLastUseOfSrc(c_instr, 0);
+
+    //
+    // taken path, OSR
+    //
+    arg_vars[0] = RT(4);
+
+    c_instr = branch_instr;
+    APPEND_INSTR6(ADD, RT(4), RT(1), g0);
+    APPEND_INSTR1(CALL, (int) EH_transfer_to_osr_code);
+    CFGGen_process_for_function_call(cfg, c_instr, EH_transfer_to_osr_code,
+				     1, arg_vars, 0, NULL);
+    CFG_MarkExceptionGeneratableInstr(cfg, c_instr);
+
+    Instr_connect_instruction(c_instr, join_instr);
+
+    return join_instr;
+}
+
+/* Name        : CSeq_create_block_count_code
+   Description : create the basic block counter put at the start of a
+                 block of lightly translated code
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       counter is given by Pbc_get_block_counter()
+   Post-condition:
+   
+   Notes: no call is made, so that the profile can be always
+          collected.  */
+InstrNode *
+CSeq_create_block_count_code(CFG *cfg, InstrNode *p_instr, int pc,
+			     InstrNode **first_instr, uint32 *counter)
+{
+    //
+    //    sethi  %hi(counter), rt0
+    //    ld     [rt0+%lo(counter)], it1
+    //    add    it1, 1, it2
+    //    st     it2, [rt0+%lo(counter)]
+    //
+    InstrNode *c_instr = p_instr;
+
+    APPEND_INSTR2(SETHI, RT(0), HI(counter));
+    if (first_instr != NULL) *first_instr = c_instr;
+    APPEND_INSTR5(LD, IT(1), RT(0), LO(counter));
+    APPEND_INSTR5(ADD, IT(2), IT(1), 1);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR8(ST, IT(2), RT(0), LO(counter));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+
+    return c_instr;
+}
+#endif /* METHOD_COUNT */
+
+/*
+ * Inline allocation
+ *
+ * Small objects and arrays are allocated by bumping the cursor of the
+ * linear allocation buffer of the small object area (gc_small_lab)
+ * inline.  The original call is left as the slow path, which is taken
+ * only when the buffer overflows.
+ *
+ * The buffer is shared by all threads, and a thread preempted by the
+ * alarm signal between loading and storing the cursor would hand out
+ * the same memory twice.  So the bump is bracketed by incrementing
+ * and decrementing blockInts, just like LOCK() in gc_malloc_small().
+ * alarmException() does not switch threads while blockInts is
+ * nonzero; it only retries later, so no reschedule check is needed
+ * when blockInts is decremented.
+ */
+
+/* Name        : append_block_ints_code
+   Description : append the code adding delta to blockInts
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       it0, it1 and it10 are dead.
+   Post-condition:
+       returns the last instruction appended.
+   Notes: delta is 1 for intsDisable() and -1 to undo it.  no thread
+          switch can happen while blockInts is raised, so it is simply
+          decremented again.  */
+static InstrNode *
+append_block_ints_code(CFG *cfg, InstrNode *c_instr, int pc, int delta)
+{
+    //
+    //    sethi  %hi(&blockInts), it10
+    //    ld     [it10+%lo(&blockInts)], it0
+    //    add    it0, delta, it1
+    //    st     it1, [it10+%lo(&blockInts)]
+    //
+    APPEND_INSTR2(SETHI, IT(10), HI(&blockInts));
+    APPEND_INSTR5(LD, IT(0), IT(10), LO(&blockInts));
+    APPEND_INSTR5(ADD, IT(1), IT(0), delta);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR8(ST, IT(1), IT(10), LO(&blockInts));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+
+    return c_instr;
+}
+
+/* Name        : get_alloc_setup_code
+   Description : find the first instruction of the argument setup code
+                 of the allocation call
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   
+   Post-condition:
+       returns NULL if the code is not the one made by translate.def.
+   Notes: `num' is the number of instructions preceding the call in
+          the setup code.  */
+static InstrNode *
+get_alloc_setup_code(InstrNode *call_instr, int num)
+{
+    InstrNode *instr = call_instr;
+    InstrNode *pred;
+
+    for (; num > 0; num--) {
+        if (Instr_GetNumOfPreds(instr) != 1) return NULL;
+        instr = Instr_GetPred(instr, 0);
+        if (Instr_GetNumOfSuccs(instr) != 1) return NULL;
+    }
+
+    /* The inline code is spliced in between the setup code and its
+       predecessor. */
+    if (Instr_GetNumOfPreds(instr) != 1) return NULL;
+    pred = Instr_GetPred(instr, 0);
+    if (Instr_GetNumOfSuccs(pred) != 1) return NULL;
+
+    return instr;
+}
+
+/* Name        : CSeq_create_inline_new_code
+   Description : create the inline allocation code for `new'
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       setup_instr is `add g0, size, it0' followed by the call to
+       gc_malloc_small(), and its single predecessor is p_instr.
+   Post-condition:
+       the call becomes the slow path.
+   Notes: the object header is set here.  the dispatch table is
+          stored by the code following the call, as before.  */
+static void
+CSeq_create_inline_new_code(CFG *cfg, InstrNode *p_instr,
+                            InstrNode *setup_instr, InstrNode *call_instr,
+                            int size)
+{
+    //
+    //    blockInts += 1 (see append_block_ints_code())
+    //    sethi  %hi(&gc_small_lab), it1
+    //    ld     [it1+%lo(&gc_small_lab)], it2          <- cursor
+    //    add    it2, size, it3
+    //    ld     [it1+%lo(&gc_small_lab)+4], it4        <- bound
+    //    subcc  it3, it4, g0
+    //    bgu    SLOW
+    //    st     it3, [it1+%lo(&gc_small_lab)]
+    //    blockInts -= 1
+    //    add    g0, size, it5
+    //    st     it5, [it2]                             <- object header
+    //    add    it2, GC_HEAD, rs{TOP+1}
+    //    goto   EXIT
+    //  SLOW:
+    //    add    g0, it2, it3    <- nop to indicate it1, it2, it3 are dead.
+    //    add    g0, it1, g0
+    //    blockInts -= 1
+    //    add    g0, size, it0
+    //    call   gc_malloc_small (o0: it0, ret: rs{TOP+1})
+    //  EXIT:
+    //
+    InstrNode *c_instr = p_instr;
+    InstrNode *branch_instr;
+    InstrNode *exit_instr = Instr_GetSucc(call_instr, 0);
+    int pc = Instr_GetBytecodePC(call_instr);
+    int ret_reg = Instr_GetRet(call_instr, 0);
+
+    Instr_disconnect_instruction(p_instr, setup_instr);
+
+    c_instr = append_block_ints_code(cfg, c_instr, pc, 1);
+
+    APPEND_INSTR2(SETHI, IT(1), HI(&gc_small_lab));
+    APPEND_INSTR5(LD, IT(2), IT(1), LO(&gc_small_lab));
+    APPEND_INSTR5(ADD, IT(3), IT(2), size);
+    APPEND_INSTR5(LD, IT(4), IT(1), LO(&gc_small_lab) + 4);
+    APPEND_INSTR6(SUBCC, g0, IT(3), IT(4));
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    APPEND_INSTR3(BGU);
+    branch_instr = c_instr;
+    CFGGen_process_for_branch(cfg, branch_instr);
+
+    APPEND_INSTR8(ST, IT(3), IT(1), LO(&gc_small_lab));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    c_instr = append_block_ints_code(cfg, c_instr, pc, -1);
+    APPEND_INSTR5(ADD, IT(5), g0, size);
+    APPEND_INSTR8(ST, IT(5), IT(2), 0);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR5(ADD, ret_reg, IT(2), GC_HEAD);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+
+    Instr_connect_instruction(c_instr, exit_instr);
+
+    // SLOW:
+    c_instr = branch_instr;
+    APPEND_INSTR6(ADD, g0, IT(2), IT(3));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    APPEND_INSTR6(ADD, g0, IT(1), g0);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    c_instr = append_block_ints_code(cfg, c_instr, pc, -1);
+
+    Instr_connect_instruction(c_instr, setup_instr);
+}
+
+/* Name        : CSeq_create_inline_newarray_code
+   Description : create the inline allocation code for `newarray' and
+                 `anewarray'
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       setup_instr is the `sethi' of the element class followed by
+       the call to newPrimArray() or newRefArray(), and its single
+       predecessor is p_instr.  the count is non-negative, which is
+       checked before.
+   Post-condition:
+       the call becomes the slow path.
+   Notes: the result shares the stack slot with the count, so it is
+          set last.  */
+static void
+CSeq_create_inline_newarray_code(CFG *cfg, InstrNode *p_instr,
+                                 InstrNode *setup_instr,
+                                 InstrNode *call_instr,
+                                 Hjava_lang_Class *array_class,
+                                 int shift, bool is_ref_array)
+{
+    //
+    //    subcc  is{TOP}, max_count, g0
+    //    bgu    SLOW
+    //    blockInts += 1 (see append_block_ints_code())
+    //    sethi  %hi(&gc_small_lab), it1
+    //    ld     [it1+%lo(&gc_small_lab)], it2          <- cursor
+    //    sll    is{TOP}, shift, it3
+    //    add    it3, ARRAY_DATA_OFFSET+GC_HEAD+MEMALIGN-1, it4
+    //    and    it4, -MEMALIGN, it5                    <- size
+    //    add    it2, it5, it6
+    //    ld     [it1+%lo(&gc_small_lab)+4], it7        <- bound
+    //    subcc  it6, it7, g0
+    //    bgu    SLOW_WITH_TEMPS
+    //    st     it6, [it1+%lo(&gc_small_lab)]
+    //    blockInts -= 1
+    //    st     it5, [it2]                             <- object header
+    //    sethi  %hi(array_class->dtable), it8
+    //    or     it8, %lo(array_class->dtable), it9
+    //    st     it9, [it2+GC_HEAD]
+    //    st     is{TOP}, [it2+GC_HEAD+ARRAY_SIZE_OFFSET]
+    //  (only for anewarray)
+    //    sethi  %hi(encoding), it8
+    //    or     it8, %lo(encoding), it9
+    //    st     it9, [it2+GC_HEAD+ARRAY_ENCODINGOFFSET]
+    //
+    //    add    it2, GC_HEAD, rs{TOP}
+    //    goto   EXIT
+    //  SLOW_WITH_TEMPS:
+    //    add    g0, it1, it2    <- nop to indicate temporaries are dead.
+    //    add    g0, it5, it6
+    //    blockInts -= 1
+    //  SLOW:
+    //    sethi  %hi(elem_class), rt0
+    //    or     rt0, %lo(elem_class), rt1
+    //    call   newPrimArray/newRefArray (o0: rt1, o1: is{TOP},
+    //                                     ret: rs{TOP})
+    //  EXIT:
+    //
+    InstrNode *c_instr = p_instr;
+    InstrNode *branch_instr1;
+    InstrNode *branch_instr2;
+    InstrNode *exit_instr = Instr_GetSucc(call_instr, 0);
+    int pc = Instr_GetBytecodePC(call_instr);
+    int count_reg = Instr_GetArg(call_instr, 1);
+    int ret_reg = Instr_GetRet(call_instr, 0);
+    int max_count = (GC_MAX_SMALL_OBJECT_SIZE - MEMALIGN
+                     - ARRAY_DATA_OFFSET - GC_HEAD) >> shift;
+    int base = GC_HEAD;
+
+    Instr_disconnect_instruction(p_instr, setup_instr);
+
+    APPEND_INSTR5(SUBCC, g0, count_reg, max_count);
+    APPEND_INSTR3(BGU);
+    branch_instr1 = c_instr;
+    CFGGen_process_for_branch(cfg, branch_instr1);
+
+    c_instr = append_block_ints_code(cfg, c_instr, pc, 1);
+
+    APPEND_INSTR2(SETHI, IT(1), HI(&gc_small_lab));
+    APPEND_INSTR5(LD, IT(2), IT(1), LO(&gc_small_lab));
+    APPEND_INSTR5(SLL, IT(3), count_reg, shift);
+    APPEND_INSTR5(ADD, IT(4), IT(3),
+                  ARRAY_DATA_OFFSET + GC_HEAD + MEMALIGN - 1);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR5(AND, IT(5), IT(4), -MEMALIGN);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR6(ADD, IT(6), IT(2), IT(5));
+    APPEND_INSTR5(LD, IT(7), IT(1), LO(&gc_small_lab) + 4);
+    APPEND_INSTR6(SUBCC, g0, IT(6), IT(7));
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    APPEND_INSTR3(BGU);
+    branch_instr2 = c_instr;
+    CFGGen_process_for_branch(cfg, branch_instr2);
+
+    APPEND_INSTR8(ST, IT(6), IT(1), LO(&gc_small_lab));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    c_instr = append_block_ints_code(cfg, c_instr, pc, -1);
+    APPEND_INSTR8(ST, IT(5), IT(2), 0);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+
+    APPEND_INSTR2(SETHI, IT(8), HI(array_class->dtable));
+    APPEND_INSTR5(OR, IT(9), IT(8), LO(array_class->dtable));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR8(ST, IT(9), IT(2), base);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    APPEND_INSTR8(ST, count_reg, IT(2), base + ARRAY_SIZE_OFFSET);
+
+    if (is_ref_array) {
+        int encoding = Class_GetEncoding(array_class);
+
+        APPEND_INSTR2(SETHI, IT(8), HI(encoding));
+        APPEND_INSTR5(OR, IT(9), IT(8), LO(encoding));
+        Instr_SetLastUseOfSrc(c_instr, 0);
+        APPEND_INSTR8(ST, IT(9), IT(2), base + ARRAY_ENCODINGOFFSET);
+        Instr_SetLastUseOfSrc(c_instr, 0);
+    }
+
+    APPEND_INSTR5(ADD, ret_reg, IT(2), GC_HEAD);
+    Instr_SetLastUseOfSrc(c_instr, 0);
+
+    Instr_connect_instruction(c_instr, exit_instr);
+
+    // SLOW_WITH_TEMPS:
+    c_instr = branch_instr2;
+    APPEND_INSTR6(ADD, g0, IT(1), IT(2));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    APPEND_INSTR6(ADD, g0, IT(5), IT(6));
+    Instr_SetLastUseOfSrc(c_instr, 0);
+    Instr_SetLastUseOfSrc(c_instr, 1);
+    c_instr = append_block_ints_code(cfg, c_instr, pc, -1);
+
+    Instr_connect_instruction(c_instr, setup_instr);
+
+    // SLOW:
+    Instr_connect_instruction(branch_instr1, setup_instr);
+}
+
+/* Name        : CSeq_insert_inline_allocation_code
+   Description : make small objects and arrays be allocated inline
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       CFG generation is done.  should be called after
+       EA_replace_allocations(), which looks for the plain calls.
+   Post-condition:
+   
+   Notes: objects with finalizers and large objects are allocated by
+          newObject() and friends, and are not handled here.  the
+          fast path raises blockInts so that it cannot be preempted
+          in the middle of bumping the shared cursor.  */
+void
+CSeq_insert_inline_allocation_code(CFG *cfg)
+{
+    int size = cfg->sizeOfList;
+    int i;
+
+    for (i = 0; i < size; i++) {
+        InstrNode *instr = cfg->instrList[i];
+        InstrNode *setup_instr;
+        InstrNode *or_instr;
+        void *func;
+
+        if (instr == NULL || Instr_GetCode(instr) != CALL
+            || !Instr_IsCall(instr) || Instr_GetNumOfSuccs(instr) != 1
+            || Instr_GetNumOfRets(instr) != 1)
+          continue;
+
+        func = (void *) instr->fields.format_1.disp30;
+
+        if (func == (void *) gc_malloc_small) {
+            if (Instr_GetNumOfArgs(instr) != 1) continue;
+            setup_instr = get_alloc_setup_code(instr, 1);
+            if (setup_instr == NULL
+                || Instr_GetCode(setup_instr) != ADD
+                || setup_instr->format != FORMAT_5
+                || setup_instr->fields.format_5.srcReg != g0
+                || setup_instr->fields.format_5.destReg
+                   != Instr_GetArg(instr, 0))
+              continue;
+
+            CSeq_create_inline_new_code(cfg,
+                                        Instr_GetPred(setup_instr, 0),
+                                        setup_instr, instr,
+                                        setup_instr->fields.format_5.simm13);
+        } else if (func == (void *) newPrimArray
+                   || func == (void *) newRefArray) {
+            Hjava_lang_Class *elem_class;
+            Hjava_lang_Class *array_class;
+            int elem_size, shift;
+
+            if (Instr_GetNumOfArgs(instr) != 2) continue;
+            setup_instr = get_alloc_setup_code(instr, 2);
+            if (setup_instr == NULL || Instr_GetCode(setup_instr) != SETHI)
+              continue;
+            or_instr = Instr_GetSucc(setup_instr, 0);
+            if (Instr_GetCode(or_instr) != OR
+                || or_instr->format != FORMAT_5
+                || or_instr->fields.format_5.srcReg
+                   != setup_instr->fields.format_2.destReg
+                || or_instr->fields.format_5.destReg
+                   != Instr_GetArg(instr, 0))
+              continue;
+
+            elem_class = (Hjava_lang_Class *)
+                ((setup_instr->fields.format_2.imm22 << 10)
+                 | or_instr->fields.format_5.simm13);
+
+            /* The array class is created by the first execution of
+               the slow path. */
+            array_class = Class_GetArrayType(elem_class);
+            if (array_class == NULL) continue;
+
+            elem_size = (func == (void *) newRefArray)
+                ? PTR_TYPE_SIZE : TYPE_SIZE(elem_class);
+            for (shift = 0; (1 << shift) < elem_size; shift++);
+            if ((1 << shift) != elem_size) continue;
+
+            CSeq_create_inline_newarray_code(cfg,
+                                             Instr_GetPred(setup_instr, 0),
+                                             setup_instr, instr,
+                                             array_class, shift,
+                                             func == (void *) newRefArray);
+        }
+    }
+}
+
 #include "InvokeType.h"
 #ifdef INVOKE_STATUS
 
@@ -1602,20 +2164,29 @@ get_target_addr_of_call_site(Method* meth,
 
 static inline
 bool
-is_candidate_of_speculative_if_inlining(Method* caller, Method* callee)
+is_candidate_of_speculative_if_inlining(Method* caller, Method* callee, int pc)
 {
     return ((callee->class->subclass_head == NULL)
-            && IG_IsMethodInlinable(CFGGen_current_ig_node, callee));
+            && IG_IsMethodInlinable(CFGGen_current_ig_node, callee, pc));
 }
 
 #ifdef DYNAMIC_CHA
 static inline
 bool
-is_candidate_of_speculative_inlining(Method* caller, Method* callee)
+is_candidate_of_speculative_inlining(Method* caller, Method* callee, int pc)
 {
+    // Unless the caller can be deoptimized when the callee gets
+    // overridden, only tiny methods are worth the permanent guard.
+    // Only final translations of normal flows get an entry for
+    // deoptimization (see need_deopt_entry in code_gen.c).
     return (callee->isOverridden == false
-            && IG_IsMethodInlinable(CFGGen_current_ig_node, callee)
-            && Method_GetByteCodeLen(callee) <= 15);
+            && IG_IsMethodInlinable(CFGGen_current_ig_node, callee, pc)
+            && (Method_GetByteCodeLen(callee) <= 15
+#ifdef METHOD_COUNT
+                || (flag_deopt && !The_Need_Retranslation_Flag
+                    && !CFGGen_from_exception)
+#endif
+                ));
 }
 
 static InstrNode*
@@ -1680,6 +2251,137 @@ _create_speculative_inlining_code(CFG *cfg, InstrNode *p_instr, int pc,
 
 #endif
 
+/* intrinsic methods of java.lang.Math which are translated into
+   inline code instead of calls */
+static struct {
+    char *name;
+    char *signature;
+    int kind;
+} math_intrinsics[] = {
+    { "sqrt", "(D)D", INTRINSIC_DSQRT },
+    { "abs", "(D)D", INTRINSIC_DABS },
+    { "abs", "(F)F", INTRINSIC_FABS },
+    { "abs", "(I)I", INTRINSIC_IABS },
+    { "min", "(II)I", INTRINSIC_IMIN },
+    { "max", "(II)I", INTRINSIC_IMAX },
+    { NULL, NULL, INTRINSIC_NONE }
+};
+
+/* Name        : CSeq_get_intrinsic_kind
+   Description : find out whether a method is translated into inline code
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   
+   Post-condition: returns INTRINSIC_NONE if the method is not an
+                   intrinsic method
+   
+   Notes: The methods are static, so no receiver type can override
+          them. */
+int
+CSeq_get_intrinsic_kind(Method* method)
+{
+    int i;
+
+    if (strcmp(Class_GetName(Method_GetDefiningClass(method))->data,
+               "java/lang/Math") != 0)
+      return INTRINSIC_NONE;
+
+    for (i = 0; math_intrinsics[i].name != NULL; i++) {
+        if (strcmp(Method_GetName(method)->data,
+                   math_intrinsics[i].name) == 0
+            && strcmp(Method_GetSignature(method)->data,
+                      math_intrinsics[i].signature) == 0)
+          return math_intrinsics[i].kind;
+    }
+    return INTRINSIC_NONE;
+}
+
+/* Name        : CSeq_create_intrinsic_code
+   Description : make inline code for an intrinsic method
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition: the arguments are on the top of the operand stack.
+   
+   Post-condition: the result is left in the operand stack entry of
+                   the first argument.
+   
+   Notes: ops_top is not changed in this function. */
+InstrNode*
+CSeq_create_intrinsic_code(CFG* cfg, InstrNode* p_instr, int pc,
+                           int kind, int ops_top)
+{
+    InstrNode* c_instr = p_instr;
+    InstrNode *branch_instr, *end_instr;
+
+    switch (kind) {
+      case INTRINSIC_DSQRT:
+        //    fsqrtd  ds{TOP-1}, ds{TOP-1}
+        APPEND_INSTR6(FSQRTD, DS(ops_top - 1), g0, DS(ops_top - 1));
+        Instr_SetLastUseOfSrc(c_instr, 1);
+        break;
+
+      case INTRINSIC_DABS:
+        //    fabsd   ds{TOP-1}, ds{TOP-1}
+        APPEND_INSTR6(FABSD, DS(ops_top - 1), g0, DS(ops_top - 1));
+        Instr_SetLastUseOfSrc(c_instr, 1);
+        break;
+
+      case INTRINSIC_FABS:
+        //    fabss   fs{TOP}, fs{TOP}
+        APPEND_INSTR6(FABSS, FS(ops_top), g0, FS(ops_top));
+        Instr_SetLastUseOfSrc(c_instr, 1);
+        break;
+
+      case INTRINSIC_IABS:
+        //    sra     is{TOP}, 31, it0
+        //    xor     is{TOP}, it0, it1
+        //    sub     it1, it0, is{TOP}
+        APPEND_INSTR5(SRA, IT(0), IS(ops_top), 31);
+        APPEND_INSTR6(XOR, IT(1), IS(ops_top), IT(0));
+        APPEND_INSTR6(SUB, IS(ops_top), IT(1), IT(0));
+        Instr_SetLastUseOfSrc(c_instr, 0);
+        Instr_SetLastUseOfSrc(c_instr, 1);
+        break;
+
+      case INTRINSIC_IMIN:
+      case INTRINSIC_IMAX:
+        //    subcc   is{TOP-1}, is{TOP}, g0
+        //    ble     KEEP              (bge for max)
+        // NORMAL:
+        //    add     is{TOP}, g0, is{TOP-1}
+        // FINISH:
+        //    NOP
+        // KEEP:
+        //    add     g0, is{TOP}, g0   <- nop to indicate is{TOP} is dead.
+        //    goto    FINISH
+        APPEND_INSTR6(SUBCC, g0, IS(ops_top - 1), IS(ops_top));
+        APPEND_INSTR3(kind == INTRINSIC_IMIN ? BLE : BGE);
+        branch_instr = c_instr;
+        CFGGen_process_for_branch(cfg, branch_instr);
+
+        // NORMAL
+        APPEND_INSTR6(ADD, IS(ops_top - 1), IS(ops_top), g0);
+        Instr_SetLastUseOfSrc(c_instr, 0);
+
+        // FINISH
+        APPEND_NOP();
+        end_instr = c_instr;
+
+        // KEEP
+        c_instr = branch_instr;
+        APPEND_INSTR6(ADD, g0, IS(ops_top), g0);
+        Instr_SetLastUseOfSrc(c_instr, 0);
+        Instr_connect_instruction(c_instr, end_instr);
+
+        c_instr = end_instr;
+        break;
+
+      default:
+        assert(false);
+    }
+
+    return c_instr;
+}
+
 /* Name        : CSeq_make_corresponding_invoke_sequence
    Description : make corresponding invoke sequence
    Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
@@ -1705,7 +2407,7 @@ CSeq_make_corresponding_invoke_sequence(CFG* cfg, InstrNode* p_instr, int pc,
     Method* caller_method = IG_GetMethod(CFGGen_current_ig_node);
 
     if (resolved == true) {
-        if (IG_IsMethodInlinable(CFGGen_current_ig_node, callee_method)) {
+        if (IG_IsMethodInlinable(CFGGen_current_ig_node, callee_method, pc)) {
             c_instr = _create_method_inline_code(cfg, c_instr, pc,
                                                  CFGGen_current_ig_node,
                                                  callee_method, argset,
@@ -1729,7 +2431,7 @@ CSeq_make_corresponding_invoke_sequence(CFG* cfg, InstrNode* p_instr, int pc,
         //check if it is a candidate of specialization
 #if defined(CUSTOMIZATION)
         if (The_Use_Specialization_Flag
-            && !IG_IsMethodInlinable(CFGGen_current_ig_node, callee_method)
+            && !IG_IsMethodInlinable(CFGGen_current_ig_node, callee_method, pc)
             && argset != NULL
             && AS_GetCount(argset) >= 1) {
             CallContext* cc =
@@ -1760,7 +2462,7 @@ CSeq_make_corresponding_invoke_sequence(CFG* cfg, InstrNode* p_instr, int pc,
             unsigned v_call =
                 find_appropriate_virtual_call_implementation_type(caller_method, pc);
 #ifdef DYNAMIC_CHA
-            if (is_candidate_of_speculative_inlining(caller_method, callee_method)) {
+            if (is_candidate_of_speculative_inlining(caller_method, callee_method, pc)) {
                 c_instr = 
                     _create_speculative_inlining_code(cfg, c_instr, pc,
                                                       CFGGen_current_ig_node,
@@ -1771,7 +2473,7 @@ CSeq_make_corresponding_invoke_sequence(CFG* cfg, InstrNode* p_instr, int pc,
             } else
 #endif
             if (v_call == CSI_UNKNOWN) {
-                if (is_candidate_of_speculative_if_inlining(caller_method, callee_method)) {
+                if (is_candidate_of_speculative_if_inlining(caller_method, callee_method, pc)) {
                     receiver_type = callee_method->class;
 
                     c_instr = 
@@ -1797,10 +2499,17 @@ CSeq_make_corresponding_invoke_sequence(CFG* cfg, InstrNode* p_instr, int pc,
                 c_instr = _create_ld_ld_jmpl_code(cfg, c_instr, pc,
                                                   info, meth_idx, ops_top);
 
+            } else if (v_call == CSI_POLYMORPHIC) {
+                // no receiver type dominates, so let a polymorphic
+                // inline cache be made again
+                c_instr = _create_inline_cache_code(cfg, c_instr, pc,
+                                                    info, meth_idx,
+                                                    dispatch_method_with_inlinecache);
+
             } else { // CallSiteInfo == CSI_IFINLINE
                 callee_method = (Method*)v_call; 
                 
-                if (!IG_IsMethodInlinable(CFGGen_current_ig_node, callee_method)) {
+                if (!IG_IsMethodInlinable(CFGGen_current_ig_node, callee_method, pc)) {
                     c_instr = _create_ld_ld_jmpl_code(cfg, c_instr, pc,
                                                       info, meth_idx, ops_top);
                 } else { // if 'method inlining' is possible
@@ -1934,9 +2643,12 @@ _create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, InstrNode* d_instr,
     InstrNode* c_instr = p_instr;
     int32 key, dest;
     int32 low, high;
+    uint32 range;
     
     low = BCode_get_int32(pair_array);
     high = BCode_get_int32(pair_array + (num_of_pairs-1)*8);
+    // high - low can overflow, so the range is computed as unsigned.
+    range = (uint32) high - (uint32) low;
 
     if (num_of_pairs <= 2) {
         int i;
@@ -1957,7 +2669,7 @@ _create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, InstrNode* d_instr,
         // connect fall-through path to default instruction
         Instr_connect_instruction(c_instr, d_instr);
 
-    } else if (num_of_pairs >= 8 && (high-low+1) <= (num_of_pairs*3 - 8)) {
+    } else if (num_of_pairs >= 8 && range < (uint32) (num_of_pairs*3 - 8)) {
         // Condition:
         //  1. num_pairs > 7 : height > 2 (1+2+4=7)
         //     if height is lower than or equal to 2, then binary search 
@@ -1978,7 +2690,7 @@ _create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, InstrNode* d_instr,
         //  DEFAULT:
         InstrNode* branch_instr;
         InstrNode* jump_instr;
-        int jump_table_size = high - low + 1;
+        int jump_table_size = range + 1;
         int num_of_dests = 0;
         int* jump_table = 
             (int*) FMA_calloc((jump_table_size + 1) * sizeof(void*));
@@ -2097,6 +2809,80 @@ _create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, InstrNode* d_instr,
 
     }
 }
+#ifdef METHOD_COUNT
+/* maximum number of cases tested before the search */
+#define MAX_HOT_CASES   2
+
+/* Name        : _create_hot_case_code
+   Description : test the hottest cases of lookupswitch first
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       the block counts of the light translation are available.
+   Post-condition:
+       returns the instruction on the path where none of the hot
+       cases matched.
+   Notes: The count of the block at a case target is used as the
+          count of the case.  A case is hot if it is taken in more
+          than half of the executions not taken by the hotter cases.
+          A target which is also reached from elsewhere can have a
+          larger count than the switch, so it is not considered. */
+static InstrNode*
+_create_hot_case_code(CFG* cfg, InstrNode* p_instr, Method* method,
+                      int pc, int ops_top, int num_of_pairs,
+                      byte* pair_array)
+{
+    InstrNode* c_instr = p_instr;
+    uint8* binfo = Method_GetBcodeInfo(method);
+    int hot_pairs[MAX_HOT_CASES];
+    int num_of_hot_pairs = 0;
+    int remaining, bpc, i, j;
+
+    for (bpc = pc; bpc > 0 && !(binfo[bpc] & METHOD_BLOCK_START); bpc--);
+    remaining = Pbc_get_block_count(method, bpc);
+    if (remaining <= 0) return c_instr;
+
+    while (num_of_hot_pairs < MAX_HOT_CASES) {
+        int best = -1;
+        int best_count = 0;
+
+        for (i = 0; i < num_of_pairs; i++) {
+            int dest = pc + BCode_get_int32(pair_array + 4 + i*8);
+            int count = Pbc_get_block_count(method, dest);
+
+            for (j = 0; j < num_of_hot_pairs; j++) {
+                if (BCode_get_int32(pair_array + 4 + hot_pairs[j]*8)
+                    == BCode_get_int32(pair_array + 4 + i*8))
+                  break;
+            }
+            if (j < num_of_hot_pairs || count > remaining) continue;
+
+            if (count > best_count) {
+                best = i;
+                best_count = count;
+            }
+        }
+
+        if (best < 0 || best_count * 2 <= remaining) break;
+
+        hot_pairs[num_of_hot_pairs++] = best;
+        remaining -= best_count;
+    }
+
+    for (i = 0; i < num_of_hot_pairs; i++) {
+        int32 key = BCode_get_int32(pair_array + hot_pairs[i]*8);
+        int32 dest = pc + BCode_get_int32(pair_array + 4 + hot_pairs[i]*8);
+
+        APPEND_IMM_ARITHMETIC_INSTR(SUBCC, g0, IS(ops_top+1), key, 0);
+        APPEND_INSTR3(BE);
+        CFGGen_process_for_branch(cfg, c_instr);
+
+        CFGGen_process_and_verify_for_npc(dest, c_instr);
+    }
+
+    return c_instr;
+}
+#endif /* METHOD_COUNT */
+
 /* Name        : CSeq_create_lookupswitch_code
    Description : generate code for lookupswitch.
    Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
@@ -2107,6 +2893,9 @@ _create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, InstrNode* d_instr,
     subregions. Kemal suggested the following idea, and I have implemented
     it according the idea - walker.
 
+    With the block profile of the light translation, the hottest cases
+    are tested before all others.
+
     When the number of values in the subregion is just 2 or 1,
     generate sequence of compare and branch.
     Otherwise, when the highest and lowest values in a subregion of values 
@@ -2119,7 +2908,7 @@ _create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, InstrNode* d_instr,
 InstrNode*
 CSeq_create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, int pc,
                               int ops_top, int num_of_pairs,
-                              byte* pair_array)
+                              byte* pair_array, Method* method)
 {
     InstrNode* c_instr = p_instr;
     InstrNode* d_instr;
@@ -2129,6 +2918,13 @@ CSeq_create_lookupswitch_code(CFG* cfg, InstrNode* p_instr, int pc,
 
     Instr_disconnect_instruction(p_instr, d_instr);
 
+#ifdef METHOD_COUNT
+    if (!The_Need_Retranslation_Flag && num_of_pairs > 2) {
+        p_instr = _create_hot_case_code(cfg, p_instr, method, pc, ops_top,
+                                        num_of_pairs, pair_array);
+    }
+#endif /* METHOD_COUNT */
+
     _create_lookupswitch_code(cfg, p_instr, d_instr, pc, ops_top,
                               num_of_pairs, pair_array);
 
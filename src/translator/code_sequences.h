@@ -32,9 +32,31 @@ CSeq_insert_debug_code(struct CFG *cfg,
 void
 CSeq_insert_monitorenter_code(struct CFG* cfg, struct InlineGraph* graph);
 
+void
+CSeq_insert_inline_allocation_code(struct CFG* cfg);
+
 void
 CSeq_insert_counting_code(struct CFG* cfg, struct SpecializedMethod_t *m);
 
+/* kinds of intrinsic methods */
+#define INTRINSIC_NONE          0
+#define INTRINSIC_DSQRT         1       /* Math.sqrt(double) */
+#define INTRINSIC_DABS          2       /* Math.abs(double) */
+#define INTRINSIC_FABS          3       /* Math.abs(float) */
+#define INTRINSIC_IABS          4       /* Math.abs(int) */
+#define INTRINSIC_IMIN          5       /* Math.min(int, int) */
+#define INTRINSIC_IMAX          6       /* Math.max(int, int) */
+
+int
+CSeq_get_intrinsic_kind(struct _methods *method);
+
+struct InstrNode *
+CSeq_create_intrinsic_code(struct CFG *cfg,
+                           struct InstrNode *p_instr,
+                           int pc,
+                           int kind,
+                           int ops_top);
+
 struct InstrNode *
 CSeq_create_monitorenter_code(struct CFG *cfg, 
                               struct InstrNode *p_instr, 
@@ -78,6 +100,9 @@ struct InstrNode *
 CSeq_create_exception_handler_prologue_code(struct CFG *cfg, 
                                             struct InlineGraph *gr);
 struct InstrNode *
+CSeq_create_osr_prologue_code(struct CFG *cfg, 
+                              struct InlineGraph *gr);
+struct InstrNode *
 CSeq_create_inline_prologue_code(struct CFG *cfg, 
                                  struct InlineGraph *graph);
 struct InstrNode *
@@ -122,6 +147,21 @@ CSeq_create_process_class_code(struct CFG *cfg,
                                int pc,
                                struct InstrNode **first_instr,
                                struct Hjava_lang_Class* class);
+#ifdef METHOD_COUNT
+struct InstrNode *
+CSeq_create_back_edge_count_code(struct CFG *cfg, 
+                                 struct InstrNode *p_instr, 
+                                 int pc,
+                                 struct InstrNode **first_instr,
+                                 void *owner,
+                                 int *counter);
+struct InstrNode *
+CSeq_create_block_count_code(struct CFG *cfg, 
+                             struct InstrNode *p_instr, 
+                             int pc,
+                             struct InstrNode **first_instr,
+                             uint32 *counter);
+#endif /* METHOD_COUNT */
 
 
 struct InstrNode*
@@ -157,6 +197,7 @@ struct InstrNode*
 CSeq_create_lookupswitch_code(struct CFG* cfg, 
                               struct InstrNode* p_instr, int pc,
                               int ops_top, int num_of_pairs,
-                              byte* pair_array);
+                              byte* pair_array,
+                              struct _methods* method);
 
 #endif /* __CODE_SEQUENCE_H__ */
@@ -0,0 +1,563 @@
+/* code_sweeper.c
+
+   Reclamation of code made obsolete by retranslation
+
+   When a method is retranslated, the beginning of the old code is
+   overwritten with a call site fixer (see generate_fixed_call_fixup()
+   in translate.c), so that callers which still refer to the old code
+   are redirected to the new one.  The rest of the old code, its data
+   segment, its variable maps, its exception information table, and
+   the exception handlers translated for it are useless once no stack
+   frame executes them any more.  They are kept in a list of retired
+   translations, which is swept after every retranslation.
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#include "config.h"
+#include <stdio.h>
+#include <assert.h>
+#include "gtypes.h"
+#include "classMethod.h"
+#include "thread.h"
+#include "gc.h"
+#include "stackTrace.h"
+#include "method_inlining.h"
+#include "exception_info.h"
+#include "code_sweeper.h"
+
+#ifdef USE_CODE_ALLOCATOR
+#include "mem_allocator_for_code.h"
+#endif
+
+#ifdef DYNAMIC_CHA
+#include "dynamic_cha.h"
+#endif
+
+#ifdef METHOD_COUNT
+#include "retranslate.h"
+
+#define DBG(s)
+
+typedef struct RetiredCode {
+    MethodInstance *instance;   /* root instance of the old translation */
+
+    /* The part of the text segment which may be freed.  The head of
+       the text segment up to bodyStart holds the type check code and
+       the call site fixer. */
+    uintp bodyStart;
+    uintp bodyEnd;
+
+    struct RetiredCode *next;
+} RetiredCode;
+
+static RetiredCode *retired_list = NULL;
+
+/* Text ranges of reclaimed translations, newest first.  Stack traces
+   keep raw return PCs until they are printed, and a PC in a range
+   reclaimed after the trace was taken may now belong to other code.
+   So the frames which the exception information table of the
+   translation gave for its PCs are copied before the table is freed.
+   They are kept as long as the VM runs, which costs much less than
+   the code and tables that are freed with them. */
+typedef struct ReclaimedSite {
+    uintp pc;
+    int first;                  /* index of the innermost frame */
+    int depth;                  /* number of frames, callers follow */
+} ReclaimedSite;
+
+typedef struct ReclaimedRange {
+    uintp start;
+    uintp end;
+    int count;                  /* num_reclaimed when it was reclaimed */
+    int numSites;
+    ReclaimedSite *sites;
+    ReclaimedFrame *frames;
+    struct ReclaimedRange *next;
+} ReclaimedRange;
+
+static ReclaimedRange *reclaimed_ranges = NULL;
+
+/* statistics */
+static int num_retired = 0;
+static int num_reclaimed = 0;
+static int num_sweeps = 0;
+static int num_busy = 0;
+
+
+/* Name        : in_retired_code
+   Description : check whether pc is within code of a retired translation
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+
+   Notes: exception handlers translated for the old translation are
+          also considered to be part of it. */
+static
+bool
+in_retired_code(RetiredCode *code, uintp pc)
+{
+    MethodInstance *owner;
+    MethodInstance *handler;
+
+    if (pc >= code->bodyStart && pc < code->bodyEnd)
+      return true;
+
+    // the call site fixer at the head is not registered
+    owner = findMethodFromPC(pc);
+    if (owner == NULL)
+      return false;
+    if (owner == code->instance)
+      return true;
+
+    for (handler = MI_GetHandlerInstances(code->instance);
+         handler != NULL;
+         handler = MI_GetNextHandlerInstance(handler)) {
+        if (owner == handler)
+          return true;
+    }
+
+    return false;
+}
+
+/* Name        : in_retired_text
+   Description : check whether a word on a stack may be a pc within
+                 code of a retired translation
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+
+   Notes: only the text ranges are compared, since every word of the
+          stacks is checked.  The code of OSR entries is in handler
+          instances as well. */
+static
+bool
+in_retired_text(RetiredCode *code, uintp word)
+{
+    MethodInstance *handler;
+    uintp start;
+
+    if (word >= code->bodyStart && word < code->bodyEnd)
+      return true;
+
+    for (handler = MI_GetHandlerInstances(code->instance);
+         handler != NULL;
+         handler = MI_GetNextHandlerInstance(handler)) {
+        start = (uintp) MI_GetTextSeg(handler);
+        if (start != 0 && word >= start
+            && word < start + MI_GetTextSegSize(handler))
+          return true;
+    }
+
+    return false;
+}
+
+/* used while walking stack frames */
+struct busy_check {
+    RetiredCode *code;
+    bool busy;
+};
+
+static
+int
+check_frame(uintp pc, void *info)
+{
+    struct busy_check *check = (struct busy_check *) info;
+
+    if (in_retired_code(check->code, pc)) {
+        check->busy = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Name        : is_busy
+   Description : check whether some thread still executes a retired
+                 translation
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+
+   Notes: A thread which was preempted by the alarm signal has its
+          interrupted pc in the signal context, not in a frame.  So
+          the stacks of the other threads are also scanned
+          conservatively, for the body and for the exception handlers
+          and OSR entries translated for it. */
+static
+bool
+is_busy(RetiredCode *code)
+{
+    Hjava_lang_Thread *tid;
+    struct busy_check check;
+
+    check.code = code;
+    check.busy = false;
+
+    for (tid = liveThreads; tid != NULL; tid = TCTX(tid)->nextlive) {
+        walk_thread_frames(tid, check_frame, &check);
+        if (check.busy)
+          return true;
+
+        if (tid != currentThread && unhand(tid)->PrivateInfo != 0) {
+            ctx *ct = TCTX(tid);
+            uintp *p;
+
+            for (p = (uintp *) ct->restorePoint;
+                 p < (uintp *) ct->stackEnd; p++) {
+                if (in_retired_text(code, *p))
+                  return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static
+void
+free_instance_data(MethodInstance *instance)
+{
+    ExceptionInfoTable *table = MI_GetExceptionInfoTable(instance);
+
+    if (table != NULL) {
+        gc_free_fixed(table->info);
+        gc_free_fixed(table);
+    }
+
+    if (MI_GetDataSeg(instance) != NULL)
+      gc_free_fixed(MI_GetDataSeg(instance));
+
+    if (MI_GetVarMapPool(instance) != NULL)
+      gc_free_fixed(MI_GetVarMapPool(instance));
+}
+
+/* Name        : add_reclaimed_range
+   Description : remember the frames of the code of a method instance
+                 which is about to be freed
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       the exception information table of instance is not freed yet
+   Post-condition:
+
+   Notes: each native PC in the table maps to the inlined method it
+          belongs to, followed by its callers up to the root method,
+          just as MI_walk_pc() in stackTrace.c would resolve it. */
+static
+void
+add_reclaimed_range(MethodInstance *instance, uintp start, uintp end)
+{
+    ExceptionInfoTable *table = MI_GetExceptionInfoTable(instance);
+    ReclaimedRange *range;
+    MethodInstance *member;
+    ExceptionInfo *einfo;
+    int num_frames;
+    int i, j;
+
+    if (start >= end)
+      return;
+
+    range = gc_malloc_fixed(sizeof(ReclaimedRange));
+    range->start = start;
+    range->end = end;
+    range->count = num_reclaimed;
+    range->numSites = 0;
+    range->sites = NULL;
+    range->frames = NULL;
+
+    num_frames = 0;
+    for (i = 0; table != NULL && i < table->size; i++) {
+        einfo = &table->info[i];
+        if (EIT_GetNativePC(einfo) == 0)
+          continue;
+
+        range->numSites++;
+        for (member = EIT_GetMethodInstance(einfo);
+             member != NULL;
+             member = MI_GetCaller(member))
+          num_frames++;
+    }
+
+    if (range->numSites > 0) {
+        range->sites = gc_malloc_fixed(range->numSites
+                                       * sizeof(ReclaimedSite));
+        range->frames = gc_malloc_fixed(num_frames
+                                        * sizeof(ReclaimedFrame));
+
+        num_frames = 0;
+        for (i = 0, j = 0; i < table->size; i++) {
+            ReclaimedSite *site;
+            int bpc;
+
+            einfo = &table->info[i];
+            if (EIT_GetNativePC(einfo) == 0)
+              continue;
+
+            site = &range->sites[j++];
+            site->pc = (uintp) EIT_GetNativePC(einfo);
+            site->first = num_frames;
+            site->depth = 0;
+
+            bpc = EIT_GetBytecodePC(einfo);
+            for (member = EIT_GetMethodInstance(einfo);
+                 member != NULL;
+                 member = MI_GetCaller(member)) {
+                range->frames[num_frames].method = MI_GetMethod(member);
+                range->frames[num_frames].bpc = bpc;
+                num_frames++;
+                site->depth++;
+
+                bpc = MI_GetRetBPC(member);
+            }
+        }
+    }
+
+    range->next = reclaimed_ranges;
+    reclaimed_ranges = range;
+}
+
+/* Name        : reclaim
+   Description : free everything of a retired translation except the
+                 head of its text segment
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       no stack frame refers to the retired translation
+   Post-condition:
+
+   Notes: method instances of inlined methods are not freed.
+          speculative call sites in the code must be forgotten before
+          the code is freed, or a later override would patch memory
+          which may already hold other code. */
+static
+void
+reclaim(RetiredCode *code)
+{
+    MethodInstance *instance = code->instance;
+    MethodInstance *handler;
+    MethodInstance *next;
+    OSREntry *entry;
+    OSREntry *next_entry;
+
+    for (handler = MI_GetHandlerInstances(instance);
+         handler != NULL;
+         handler = next) {
+        next = MI_GetNextHandlerInstance(handler);
+
+        if (MI_GetTextSeg(handler) != NULL) {
+#ifdef DYNAMIC_CHA
+            DCHA_remove_dependent_code(handler,
+                                       (uintp) MI_GetTextSeg(handler),
+                                       (uintp) MI_GetTextSeg(handler)
+                                       + MI_GetTextSegSize(handler));
+#endif
+            add_reclaimed_range(handler,
+                                (uintp) MI_GetTextSeg(handler),
+                                (uintp) MI_GetTextSeg(handler)
+                                + MI_GetTextSegSize(handler));
+            deregisterMethod((uintp) MI_GetTextSeg(handler),
+                             (uintp) MI_GetTextSeg(handler)
+                             + MI_GetTextSegSize(handler),
+                             handler);
+#ifdef USE_CODE_ALLOCATOR
+            CMA_free_code_block(MI_GetTextSeg(handler),
+                                MI_GetTextSegSize(handler));
+#endif
+        }
+        free_instance_data(handler);
+        gc_free_fixed(handler);
+    }
+
+    // the code of OSR entries is freed above with the handlers
+    for (entry = MI_GetOSREntries(instance);
+         entry != NULL;
+         entry = next_entry) {
+        next_entry = entry->next;
+
+        // the map is a copy made by translate_osr_entry()
+        if (entry->code != NULL)
+          gc_free_fixed(entry->initMap);
+        gc_free_fixed(entry);
+    }
+
+#ifdef DYNAMIC_CHA
+    DCHA_remove_dependent_code(instance, code->bodyStart, code->bodyEnd);
+#endif
+    add_reclaimed_range(instance, code->bodyStart, code->bodyEnd);
+    deregisterMethod(code->bodyStart, code->bodyEnd, instance);
+
+#ifdef USE_CODE_ALLOCATOR
+    if (MI_GetTextSeg(instance) != NULL)
+      CMA_shrink_code_block(MI_GetTextSeg(instance),
+                            MI_GetTextSegSize(instance),
+                            code->bodyStart
+                            - (uintp) MI_GetTextSeg(instance));
+#endif
+
+    free_instance_data(instance);
+
+    if (!MI_IsEmptyTranslatedEHCodes(instance)) {
+        gc_free_fixed(instance->translatedEHCodes);
+        gc_free_fixed(instance->initEHVarMap);
+        gc_free_fixed(instance->localVarNO);
+        gc_free_fixed(instance->stackVarNO);
+    }
+
+    gc_free_fixed(instance);
+}
+
+/* Name        : CSW_retire_code
+   Description : put an obsolete translation into the retired list
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       ocode is the old entry point, which starts with the count code
+       and has already been overwritten with the call site fixer
+   Post-condition:
+
+   Notes:  */
+void
+CSW_retire_code(MethodInstance *instance, nativecode *ocode)
+{
+    RetiredCode *code;
+
+    if (instance == NULL)
+      return;
+
+#ifdef DYNAMIC_CHA
+    // its entry is the call site fixer now
+    DCHA_retire_dependent_code(instance);
+#endif
+
+    code = gc_malloc_fixed(sizeof(RetiredCode));
+    code->instance = instance;
+
+    // the call site fixer is exactly as large as the count code
+    code->bodyStart = (uintp) ocode + COUNT_CODE_SIZE;
+
+    if (MI_GetTextSeg(instance) != NULL)
+      code->bodyEnd = (uintp) MI_GetTextSeg(instance)
+          + MI_GetTextSegSize(instance);
+    else
+      code->bodyEnd = code->bodyStart;
+
+    code->next = retired_list;
+    retired_list = code;
+
+    num_retired++;
+}
+
+/* Name        : CSW_sweep
+   Description : free retired translations which are not used any more
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       called from a point where other threads are suspended
+   Post-condition:
+
+   Notes:  */
+void
+CSW_sweep(void)
+{
+    RetiredCode **link = &retired_list;
+    RetiredCode *code;
+
+    num_sweeps++;
+
+    while (*link != NULL) {
+        code = *link;
+
+        if (is_busy(code)) {
+            num_busy++;
+            link = &code->next;
+            continue;
+        }
+
+        DBG(fprintf(stderr, "reclaiming code of %s.%s\n",
+                    MI_GetMethod(code->instance)->class->name->data,
+                    MI_GetMethod(code->instance)->name->data););
+
+        *link = code->next;
+        reclaim(code);
+        gc_free_fixed(code);
+        num_reclaimed++;
+    }
+}
+
+/* Name        : CSW_get_reclaim_count
+   Description : return the number of translations reclaimed so far
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+
+   Notes:  */
+int
+CSW_get_reclaim_count(void)
+{
+    return num_reclaimed;
+}
+
+/* Name        : CSW_find_reclaimed_frames
+   Description : find the frames of pc if it was in code reclaimed
+                 after count translations had been reclaimed
+   Maintainer  : SeungIl Lee <hacker@altair.snu.ac.kr>
+   Pre-condition:
+       count was returned by CSW_get_reclaim_count()
+   Post-condition:
+       returns false if pc was not in such code.  Otherwise *frames
+       and *depth are set to the frames pc was in, innermost first,
+       and their number, which is zero if pc was not in the exception
+       information table.
+
+   Notes: Such a pc may now be in newly translated code.  Code at the
+          same address may have been reclaimed more than once since
+          count, and the code the pc was in is the oldest of them. */
+bool
+CSW_find_reclaimed_frames(uintp pc, int count,
+                          ReclaimedFrame **frames, int *depth)
+{
+    ReclaimedRange *range;
+    ReclaimedRange *found = NULL;
+    int i;
+
+    for (range = reclaimed_ranges;
+         range != NULL && range->count >= count;
+         range = range->next) {
+        if (pc >= range->start && pc < range->end)
+          found = range;
+    }
+
+    if (found == NULL)
+      return false;
+
+    *frames = NULL;
+    *depth = 0;
+    for (i = 0; i < found->numSites; i++) {
+        if (found->sites[i].pc == pc) {
+            *frames = &found->frames[found->sites[i].first];
+            *depth = found->sites[i].depth;
+            break;
+        }
+    }
+
+    return true;
+}
+
+void
+CSW_print_statistics(void)
+{
+    RetiredCode *code;
+    int num_pending = 0;
+
+    for (code = retired_list; code != NULL; code = code->next)
+      num_pending++;
+
+    fprintf(stderr, "retired translations  = %d\n", num_retired);
+    fprintf(stderr, "reclaimed translations= %d (%d pending, "
+            "%d sweeps, %d busy checks)\n",
+            num_reclaimed, num_pending, num_sweeps, num_busy);
+#ifdef USE_CODE_ALLOCATOR
+    CMA_print_statistics();
+#endif
+}
+
+#endif /* METHOD_COUNT */
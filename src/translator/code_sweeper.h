@@ -0,0 +1,48 @@
+/* code_sweeper.h
+
+   Reclamation of code made obsolete by retranslation
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#ifndef __CODE_SWEEPER_H__
+#define __CODE_SWEEPER_H__
+
+#include "gtypes.h"
+
+#ifdef METHOD_COUNT
+
+struct MethodInstance;
+
+/* Remember that the translation whose root instance is given has been
+   replaced.  OCODE is its old entry point, which has been overwritten
+   with a call site fixer and must stay alive. */
+void CSW_retire_code(struct MethodInstance *instance, nativecode *ocode);
+
+/* Free retired translations which no stack frame refers to. */
+void CSW_sweep(void);
+
+/* Return the number of translations reclaimed so far. */
+int CSW_get_reclaim_count(void);
+
+/* A frame which a PC in reclaimed code was in. */
+typedef struct ReclaimedFrame {
+    struct _methods *method;
+    int bpc;
+} ReclaimedFrame;
+
+/* Whether PC was in the code of a translation reclaimed after COUNT,
+   as returned by CSW_get_reclaim_count(), translations had been.  If
+   so, *FRAMES is set to the *DEPTH frames it was in, innermost
+   first. */
+bool CSW_find_reclaimed_frames(uintp pc, int count,
+			       ReclaimedFrame **frames, int *depth);
+
+/* Print sweeper and code heap statistics. */
+void CSW_print_statistics(void);
+
+#endif /* METHOD_COUNT */
+
+#endif /* __CODE_SWEEPER_H__ */
@@ -9,6 +9,7 @@
    See the file LICENSE for usage and redistribution terms and a
    disclaimer of all warranties. */
 
+#include <stdio.h>
 #include "config.h"
 #include "gtypes.h"
 #include "classMethod.h"
@@ -16,6 +17,13 @@
 #include "gc.h"
 #include "SPARC_instr.h"
 #include "md.h"
+#include "flags.h"
+#include "method_inlining.h"
+#include "jit_log.h"
+
+#ifdef METHOD_COUNT
+#include "retranslate.h"
+#endif
 
 #define INITIAL_SET_SIZE 5
 
@@ -24,6 +32,9 @@
 
 #define DBG(s)
 
+// translations depending on speculatively inlined methods
+static DependentCode* dependent_list = NULL;
+
 static void
 _fixup_call_site(unsigned* addr, unsigned info)
 {
@@ -92,3 +103,147 @@ DBG(    printf("%s.%s.%s %d\n", meth->class->name->data,
     css->set[css->count].addr = addr;
     css->set[css->count++].info = target | mode;
 }
+
+
+/* Name        : DCHA_add_dependent_code
+   Description : record that a translation inlined a method speculatively
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+   
+   Notes: one entry is kept for each pair of the method and the
+          translation.  Since all the call sites of a translation are
+          added in a row, only the head of the list has to be checked. */
+void
+DCHA_add_dependent_code(Method* meth, MethodInstance* instance,
+                        void* owner, nativecode* entry)
+{
+    DependentCode* dep;
+
+    for (dep = dependent_list;
+         dep != NULL && dep->instance == instance; dep = dep->next) {
+        if (dep->callee == meth) return;
+    }
+
+    dep = DCHA_ALLOC(sizeof(DependentCode));
+    dep->callee = meth;
+    dep->instance = instance;
+    dep->owner = owner;
+    dep->entry = entry;
+    dep->next = dependent_list;
+
+    dependent_list = dep;
+}
+
+/* Name        : DCHA_invalidate_dependent_code
+   Description : deoptimize translations which inlined the overridden method
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       the call sites of the method have been fixed up.
+   Post-condition:
+       the next invocation of each dependent translation retranslates it.
+   
+   Notes: The entry of the translation is overwritten with the count code
+          whose counter is already exhausted.  Other threads are not
+          running at this point, and none of them can stop in the middle
+          of the entry since it starts with an annulled branch. */
+void
+DCHA_invalidate_dependent_code(Method* meth)
+{
+#ifdef METHOD_COUNT
+    DependentCode* dep;
+
+    if (!flag_deopt) return;
+
+    for (dep = dependent_list; dep != NULL; dep = dep->next) {
+        if (dep->callee != meth || dep->entry == NULL) continue;
+
+        if (flag_jit) {
+            Method* m = MI_GetMethod(dep->instance);
+
+            fprintf(stderr, "deoptimize %s %s %s (inlined %s %s %s)\n",
+                    m->class->name->data, m->name->data,
+                    m->signature->data, meth->class->name->data,
+                    meth->name->data, meth->signature->data);
+        }
+        if (flag_jit_log != NULL) {
+            JitLog_print_deopt(MI_GetMethod(dep->instance), meth);
+        }
+
+#ifdef CUSTOMIZATION
+        generate_count_code((SpecializedMethod*) dep->owner,
+                            (unsigned*) dep->entry,
+                            (unsigned*) (dep->entry + COUNT_CODE_SIZE));
+        ((SpecializedMethod*) dep->owner)->count = 0;
+#else
+        generate_count_code((Method*) dep->owner, (unsigned*) dep->entry,
+                            (unsigned*) (dep->entry + COUNT_CODE_SIZE));
+        ((Method*) dep->owner)->count = 0;
+#endif
+        FLUSH_DCACHE(dep->entry, dep->entry + COUNT_CODE_SIZE);
+
+        // other dependencies of the translation share the entry
+        DCHA_retire_dependent_code(dep->instance);
+    }
+#endif /* METHOD_COUNT */
+}
+
+void
+DCHA_retire_dependent_code(MethodInstance* instance)
+{
+    DependentCode* dep;
+
+    for (dep = dependent_list; dep != NULL; dep = dep->next) {
+        if (dep->instance == instance)
+          dep->entry = NULL;
+    }
+}
+
+/* Name        : DCHA_remove_dependent_code
+   Description : forget the call sites and dependencies of freed code
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       no thread executes the code in [start, end).
+   Post-condition:
+   
+   Notes: otherwise a later override would patch memory which may
+          already hold other code. */
+void
+DCHA_remove_dependent_code(MethodInstance* instance, uintp start, uintp end)
+{
+    DependentCode** link = &dependent_list;
+    DependentCode* dep;
+
+    while (*link != NULL) {
+        CallSiteSet* css;
+        int i, j;
+
+        dep = *link;
+        if (dep->instance != instance) {
+            link = &dep->next;
+            continue;
+        }
+
+        css = dep->callee->callSiteSet;
+        if (css != NULL) {
+            for (i = j = 0; i < css->count; i++) {
+                if ((uintp) css->set[i].addr >= start
+                    && (uintp) css->set[i].addr < end)
+                  continue;
+                css->set[j++] = css->set[i];
+            }
+            css->count = j;
+        }
+
+        *link = dep->next;
+        DCHA_FREE(dep);
+    }
+}
+
+void
+DCHA_make_deoptimizable_entry(unsigned* code, unsigned* target)
+{
+    *code = assemble_instr3(BA, target - code) | ANNUL_BIT;
+    for (code++; code < target; code++)
+      *code = assemble_nop();
+}
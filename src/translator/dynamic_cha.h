@@ -16,6 +16,7 @@
 #include "basic.h"
 
 struct _methods;
+struct MethodInstance;
 
 typedef enum { 
     DCHA_SPEC_CALL = 0, DCHA_SPEC_INLINE = 1 
@@ -40,6 +41,22 @@ typedef struct CallSiteSet {
     int count;
 } CallSiteSet;
 
+/* A translation which speculatively inlined a method depends on the
+   method not being overridden.  When it is, the translation is
+   deoptimized: its entry, which is reserved when the code is
+   generated, is overwritten with the count code, so that the next
+   invocation retranslates the method without the stale assumption.
+   Activations already running the old code stay correct, because the
+   guards of the inlined bodies are redirected to virtual calls by
+   DCHA_fixup_speculative_call_site(). */
+typedef struct DependentCode {
+    struct _methods* callee;            // speculatively inlined method
+    struct MethodInstance* instance;    // root instance of the translation
+    void* owner;                        // SpecializedMethod or Method
+    nativecode* entry;                  // NULL if it can't be deoptimized
+    struct DependentCode* next;
+} DependentCode;
+
 /* When the specified method is overridden, all call sites which presumes 
    that method is final have to be fixed. */
 void DCHA_fixup_speculative_call_site(struct _methods*);
@@ -49,4 +66,24 @@ void DCHA_fixup_speculative_call_site(struct _methods*);
 void DCHA_add_speculative_call_site(struct _methods*, uint32*, 
                                     uint32, SpecMode);
 
+/* remember that the translation of the given root instance inlined the
+   specified method speculatively.  owner and entry are NULL for
+   translations of exception handlers. */
+void DCHA_add_dependent_code(struct _methods*, struct MethodInstance*,
+                             void*, nativecode*);
+
+/* deoptimize the translations which depend on the specified method */
+void DCHA_invalidate_dependent_code(struct _methods*);
+
+/* The translation has been replaced, so don't touch its entry any more. */
+void DCHA_retire_dependent_code(struct MethodInstance*);
+
+/* The code of the translation in [start, end) is freed.  Forget its
+   call sites and dependencies. */
+void DCHA_remove_dependent_code(struct MethodInstance*, uintp, uintp);
+
+/* Fill the entry reserved for deoptimization, which jumps over itself
+   until it is overwritten. */
+void DCHA_make_deoptimizable_entry(unsigned*, unsigned*);
+
 #endif /* __DYNAMIC_CHA_H__ */
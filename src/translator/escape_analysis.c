@@ -0,0 +1,781 @@
+/* escape_analysis.c
+
+   Escape analysis & scalar replacement of objects
+
+   Written by: Junpyo Lee <walker@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+/*======================================================================
+  An object created by NEW is translated into
+
+      add    g0, objsize, it0
+      call   gc_malloc_small (o0: it0, ret: rs)
+      ...
+      st     rt3, [rs+0]
+
+  If the reference never leaves the method (it is not passed to a
+  call, returned, stored into memory, compared, or used for locking)
+  and reaches each of its uses without being merged with another
+  value, every field of the object can be kept in a variable.  Then
+  the call is removed, each field variable is initialized with zero,
+  and the loads & stores of fields become copies.  The object does
+  not live in the heap any more, which also means one GC pressure
+  less.
+
+  The analysis is intraprocedural on the CFG of the final
+  translation.  Methods with exception handlers are left alone,
+  because handlers are translated separately and read the object
+  from the frame.
+======================================================================*/
+
+#include "config.h"
+#include "gtypes.h"
+#include "flags.h"
+#include "InstrNode.h"
+#include "CFG.h"
+#include "SPARC_instr.h"
+#include "reg.h"
+#include "method_inlining.h"
+#include "classMethod.h"
+#include "fast_mem_allocator.h"
+#include "gc.h"
+#include "escape_analysis.h"
+
+#define DBG(s)
+
+/* The relevant variables of an allocation are kept in a word. */
+#define EA_MAX_VARS     32
+#define EA_MAX_FIELDS   16
+
+/* field kinds */
+#define EA_INT          0
+#define EA_FLOAT        1
+#define EA_DOUBLE       2
+
+/* actions on instructions */
+#define EA_KEEP         0
+#define EA_REMOVE       1
+#define EA_LOAD         2
+#define EA_STORE        3
+
+typedef struct {
+    int         offset;
+    int         kind;
+    VarType     type;           /* T_INVALID until known */
+    int         numOfLoads;
+    Var         var;            /* variable replacing the field */
+} EAField;
+
+int EA_replaced_alloc_num = 0;
+
+/* zero for initializing float & double fields */
+static long long EA_zero[1] = { 0x0000000000000000LL };
+
+/* relevant variables of the allocation being examined */
+static int      ea_var_nums[EA_MAX_VARS];
+static int      ea_num_of_vars;
+
+static EAField  ea_fields[EA_MAX_FIELDS];
+static int      ea_num_of_fields;
+
+/* Name        : has_exception_handler
+   Description : check if the method or one of its inlined methods
+                 has an exception table
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:  */
+static bool
+has_exception_handler(InlineGraph *graph)
+{
+    InlineGraph *callee;
+
+    if (Method_GetExceptionTable(IG_GetMethod(graph)) != NULL)
+        return true;
+
+    for (callee = IG_GetCallee(graph); callee != NULL;
+         callee = IG_GetNextCallee(callee)) {
+        if (has_exception_handler(callee)) return true;
+    }
+
+    return false;
+}
+
+/* Name        : is_allocation
+   Description : check if the instruction is a call to gc_malloc_small
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:  */
+static bool
+is_allocation(InstrNode *instr)
+{
+    return (Instr_GetCode(instr) == CALL
+            && instr->fields.format_1.disp30 == (int) gc_malloc_small
+            && Instr_IsCall(instr)
+            && Instr_GetNumOfArgs(instr) == 1
+            && Instr_GetNumOfRets(instr) == 1
+            && Var_IsVariable(Instr_GetRet(instr, 0))
+            && Instr_GetNumOfSuccs(instr) == 1
+            && Instr_GetNumOfPreds(instr) > 0);
+}
+
+/* Name        : get_copy_source
+   Description : return the source of an integer copy, or INVALID_REG
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:  */
+static Reg
+get_copy_source(InstrNode *instr)
+{
+    if (!Instr_IsICopy(instr)) return INVALID_REG;
+
+    if (instr->format == FORMAT_6) {
+        return (instr->fields.format_6.srcReg_1 == g0) ?
+            instr->fields.format_6.srcReg_2 : instr->fields.format_6.srcReg_1;
+    }
+
+    return instr->fields.format_5.srcReg;
+}
+
+/* Name        : get_var_bits
+   Description : return the set of relevant variables which var covers
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       Variables are compared by their numbers, so that a long or
+       double variable covers two numbers.  */
+static word
+get_var_bits(Reg var)
+{
+    VarType type;
+    int num, i;
+    word bits = 0;
+
+    if (!Var_IsVariable(var)) return 0;
+
+    type = Var_GetType(var);
+    num = CFG_get_var_number(var);
+
+    for (i = 0; i < ea_num_of_vars; i++) {
+        if (ea_var_nums[i] == num
+            || ((type == T_LONG || type == T_DOUBLE)
+                && ea_var_nums[i] == num + 1)) {
+            bits |= 1 << i;
+        }
+    }
+
+    return bits;
+}
+
+/* Name        : collect_relevant_vars
+   Description : collect the variables which may hold the reference
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+       ea_var_nums[0] is the return variable of the allocation.
+   Notes:
+       It returns false if there are too many of them.  */
+static bool
+collect_relevant_vars(CFG *cfg, Var ret)
+{
+    bool changed = true;
+    int i;
+
+    ea_var_nums[0] = CFG_get_var_number(ret);
+    ea_num_of_vars = 1;
+
+    while (changed) {
+        changed = false;
+
+        for (i = 0; i < cfg->sizeOfList; i++) {
+            InstrNode *instr = cfg->instrList[i];
+            Reg dest;
+
+            if (instr == NULL) continue;
+            if (get_var_bits(get_copy_source(instr)) == 0) continue;
+
+            dest = Instr_GetDestReg(instr, 0);
+            if (!Var_IsVariable(dest) || get_var_bits(dest) != 0) continue;
+            if (ea_num_of_vars == EA_MAX_VARS) return false;
+
+            ea_var_nums[ea_num_of_vars++] = CFG_get_var_number(dest);
+            changed = true;
+        }
+    }
+
+    return true;
+}
+
+/* Name        : mark_reached_instrs
+   Description : mark the instructions reachable from the allocation
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       It returns false if the allocation is in a cycle.  In that case
+       a variable may hold objects of different iterations.  */
+static bool
+mark_reached_instrs(CFG *cfg, InstrNode *alloc, bool *reached)
+{
+    InstrNode **stack;
+    int top = 0;
+    int i;
+
+    stack = (InstrNode **) FMA_calloc(sizeof(InstrNode *) * cfg->sizeOfList);
+
+    for (i = 0; i < Instr_GetNumOfSuccs(alloc); i++) {
+        InstrNode *succ = Instr_GetSucc(alloc, i);
+
+        if (!reached[succ->arrayIndex]) {
+            reached[succ->arrayIndex] = true;
+            stack[top++] = succ;
+        }
+    }
+
+    while (top > 0) {
+        InstrNode *instr = stack[--top];
+
+        if (instr == alloc) return false;
+
+        for (i = 0; i < Instr_GetNumOfSuccs(instr); i++) {
+            InstrNode *succ = Instr_GetSucc(instr, i);
+
+            if (!reached[succ->arrayIndex]) {
+                reached[succ->arrayIndex] = true;
+                stack[top++] = succ;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Name        : transfer
+   Description : compute the sets after an instruction
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       A copy propagates the reference; any other definition kills
+       it.  */
+static void
+transfer(InstrNode *instr, word *may, word *must)
+{
+    word src_bits, dest_bits;
+    int i;
+
+    if (Instr_IsCall(instr)) {
+        for (i = 0; i < Instr_GetNumOfRets(instr); i++) {
+            dest_bits = get_var_bits(Instr_GetRet(instr, i));
+            *may &= ~dest_bits;
+            *must &= ~dest_bits;
+        }
+        return;
+    }
+
+    if (Instr_GetNumOfDestRegs(instr) == 0) return;
+
+    dest_bits = get_var_bits(Instr_GetDestReg(instr, 0));
+    if (dest_bits == 0) return;
+
+    src_bits = get_var_bits(get_copy_source(instr));
+    if (src_bits != 0) {
+        if (*may & src_bits) *may |= dest_bits; else *may &= ~dest_bits;
+        if (*must & src_bits) *must |= dest_bits; else *must &= ~dest_bits;
+    } else {
+        *may &= ~dest_bits;
+        *must &= ~dest_bits;
+    }
+}
+
+/* Name        : compute_reference_sets
+   Description : compute which relevant variables may/must hold the
+                 reference before each instruction
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       reached[] is filled by mark_reached_instrs().
+   Post-condition:
+
+   Notes:
+       An instruction which is not reached from the allocation holds
+       no reference.  */
+static void
+compute_reference_sets(CFG *cfg, InstrNode *alloc, bool *reached,
+                       word *in_may, word *in_must)
+{
+    int size = cfg->sizeOfList;
+    word *out_may = (word *) FMA_calloc(sizeof(word) * size);
+    word *out_must = (word *) FMA_calloc(sizeof(word) * size);
+    bool changed = true;
+    int i, j;
+
+    for (i = 0; i < size; i++) {
+        if (reached[i]) out_must[i] = ~(word) 0;
+    }
+    out_may[alloc->arrayIndex] = 1;
+    out_must[alloc->arrayIndex] = 1;
+
+    while (changed) {
+        changed = false;
+
+        for (i = 0; i < size; i++) {
+            InstrNode *instr = cfg->instrList[i];
+            word may = 0, must = ~(word) 0;
+
+            if (instr == NULL || !reached[i]) continue;
+
+            for (j = 0; j < Instr_GetNumOfPreds(instr); j++) {
+                int pred = Instr_GetPred(instr, j)->arrayIndex;
+
+                may |= out_may[pred];
+                must &= out_must[pred];
+            }
+            in_may[i] = may;
+            in_must[i] = must;
+
+            transfer(instr, &may, &must);
+            if (may != out_may[i] || must != out_must[i]) {
+                out_may[i] = may;
+                out_must[i] = must;
+                changed = true;
+            }
+        }
+    }
+}
+
+/* Name        : add_field_access
+   Description : record an access of a field
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       It returns the index of the field, or -1 if the access cannot
+       be replaced.  type is T_INVALID if unknown.  */
+static int
+add_field_access(int offset, int kind, VarType type, bool is_load)
+{
+    EAField *field;
+    int i;
+
+    if (offset < 0) return -1;
+
+    switch (kind) {
+      case EA_INT:
+        if (type != T_INVALID && type != T_INT && type != T_REF) return -1;
+        break;
+      case EA_FLOAT:
+        if (type != T_FLOAT) return -1;
+        break;
+      case EA_DOUBLE:
+        if (type != T_DOUBLE) return -1;
+        break;
+    }
+
+    for (i = 0; i < ea_num_of_fields; i++) {
+        field = &ea_fields[i];
+        if (field->offset == offset) break;
+    }
+
+    if (i == ea_num_of_fields) {
+        if (ea_num_of_fields == EA_MAX_FIELDS) return -1;
+        field = &ea_fields[ea_num_of_fields++];
+        field->offset = offset;
+        field->kind = kind;
+        field->type = T_INVALID;
+        field->numOfLoads = 0;
+    } else if (field->kind != kind) {
+        return -1;
+    }
+
+    if (field->type == T_INVALID) field->type = type;
+    if (is_load) field->numOfLoads++;
+
+    return i;
+}
+
+/* Name        : has_overlapped_fields
+   Description : check if two fields share a word
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:  */
+static bool
+has_overlapped_fields(void)
+{
+    int i, j;
+
+    for (i = 0; i < ea_num_of_fields; i++) {
+        for (j = 0; j < ea_num_of_fields; j++) {
+            int end = ea_fields[i].offset
+                + (ea_fields[i].kind == EA_DOUBLE ? 8 : 4);
+
+            if (i != j && ea_fields[j].offset > ea_fields[i].offset
+                && ea_fields[j].offset < end)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/* Name        : classify_use
+   Description : decide what to do with an instruction which uses the
+                 reference
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+       *field_idx is set for EA_LOAD and EA_STORE.
+   Notes:
+       It returns -1 if the reference escapes through the
+       instruction.  */
+static int
+classify_use(InstrNode *instr, word ref_bits, int *field_idx)
+{
+    int code = Instr_GetCode(instr);
+    Reg dest, value;
+
+    /* copy or last-use marker */
+    if (get_var_bits(get_copy_source(instr)) & ref_bits) {
+        dest = Instr_GetDestReg(instr, 0);
+        if (dest == g0 || (get_var_bits(dest) != 0
+                           && Var_GetType(dest) != T_LONG
+                           && Var_GetType(dest) != T_DOUBLE))
+            return EA_REMOVE;
+        return -1;
+    }
+
+    /* ld [ref+offset], dest */
+    if (instr->format == FORMAT_5
+        && (code == LD || code == LDF || code == LDDF)
+        && (get_var_bits(instr->fields.format_5.srcReg) & ref_bits)) {
+        dest = instr->fields.format_5.destReg;
+
+        if (dest == g0) {
+            /* null pointer check */
+            return (code == LD) ? EA_REMOVE : -1;
+        }
+        if (!Var_IsVariable(dest)) return -1;
+
+        *field_idx = add_field_access(instr->fields.format_5.simm13,
+                                      (code == LD) ? EA_INT :
+                                      (code == LDF) ? EA_FLOAT : EA_DOUBLE,
+                                      Var_GetType(dest), true);
+        return (*field_idx < 0) ? -1 : EA_LOAD;
+    }
+
+    /* st value, [ref+offset] */
+    if (instr->format == FORMAT_8
+        && (code == ST || code == STF || code == STDF)
+        && (get_var_bits(instr->fields.format_8.srcReg_1) & ref_bits)) {
+        value = instr->fields.format_8.srcReg_2;
+
+        if (get_var_bits(value) & ref_bits) return -1;
+        if (value != g0 && !Var_IsVariable(value)) return -1;
+        if (value == g0 && code != ST) return -1;
+
+        *field_idx = add_field_access(instr->fields.format_8.simm13,
+                                      (code == ST) ? EA_INT :
+                                      (code == STF) ? EA_FLOAT : EA_DOUBLE,
+                                      (value == g0) ? T_INVALID :
+                                      Var_GetType(value), false);
+        return (*field_idx < 0) ? -1 : EA_STORE;
+    }
+
+    return -1;
+}
+
+/* Name        : get_used_bits
+   Description : return the relevant variables which an instruction uses
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:  */
+static word
+get_used_bits(InstrNode *instr)
+{
+    word bits = 0;
+    int i;
+
+    for (i = 0; i < Instr_GetNumOfSrcRegs(instr); i++) {
+        bits |= get_var_bits(Instr_GetSrcReg(instr, i));
+    }
+
+    if (Instr_IsCall(instr)) {
+        for (i = 0; i < Instr_GetNumOfArgs(instr); i++) {
+            bits |= get_var_bits(Instr_GetArg(instr, i));
+        }
+    } else if (Instr_IsReturn(instr)) {
+        for (i = 0; i < Instr_GetNumOfRets(instr); i++) {
+            bits |= get_var_bits(Instr_GetRet(instr, i));
+        }
+    }
+
+    return bits;
+}
+
+/* Name        : make_field_vars
+   Description : make new local variables for the fields
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       Local variables need no last-use marks, and they are placed
+       after all the other local variables of the method.  */
+static void
+make_field_vars(CFG *cfg)
+{
+    int i;
+
+    Var_prepare_creation(CFG_GetIGRoot(cfg));
+
+    for (i = 0; i < ea_num_of_fields; i++) {
+        EAField *field = &ea_fields[i];
+        int number = CFG_GetNumOfLocalVars(cfg);
+
+        if (field->type == T_INVALID) field->type = T_INT;
+
+        CFG_SetNumOfLocalVars(cfg,
+                              number + (field->kind == EA_DOUBLE ? 2 : 1));
+        field->var = Var_make_local(field->type,
+                                    number - Var_offset_of_local_var);
+    }
+}
+
+/* Name        : insert_field_inits
+   Description : initialize the field variables with zero in place of
+                 the allocation
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       Instructions are inserted in reverse order right after the
+       allocation.  The argument of the allocation is a temporary
+       variable, which is reused for the address of EA_zero.  */
+static void
+insert_field_inits(CFG *cfg, InstrNode *alloc)
+{
+    InstrOffset pc = Instr_GetBytecodePC(alloc);
+    Reg arg = Instr_GetArg(alloc, 0);
+    InstrNode *new_instr;
+    int i;
+
+    for (i = ea_num_of_fields - 1; i >= 0; i--) {
+        EAField *field = &ea_fields[i];
+
+        if (field->numOfLoads == 0) continue;
+
+        if (field->kind == EA_INT) {
+            new_instr = create_format5_instruction(ADD, field->var, g0, 0, pc);
+            CFG_InsertInstrAsSucc(cfg, alloc, 0, new_instr);
+        } else {
+            new_instr = create_format5_instruction(field->kind == EA_FLOAT ?
+                                                   LDF : LDDF, field->var,
+                                                   arg, LO(EA_zero), pc);
+            Instr_SetLastUseOfSrc(new_instr, 0);
+            CFG_InsertInstrAsSucc(cfg, alloc, 0, new_instr);
+            new_instr = create_format2_instruction(SETHI, arg,
+                                                   HI(EA_zero), pc);
+            CFG_InsertInstrAsSucc(cfg, alloc, 0, new_instr);
+        }
+    }
+
+    /* The call was the last use of the argument. */
+    if (Var_IsVariable(arg) && Var_GetStorageType(arg) != ST_LOCAL) {
+        new_instr = create_format6_instruction(ADD, g0, arg, g0, -1);
+        Instr_SetLastUseOfSrc(new_instr, 0);
+        CFG_InsertInstrAsSucc(cfg, alloc, 0, new_instr);
+    }
+}
+
+/* Name        : replace_field_access
+   Description : replace a load or a store of a field with a copy
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:  */
+static void
+replace_field_access(CFG *cfg, InstrNode *instr, EAField *field)
+{
+    InstrOffset pc = Instr_GetBytecodePC(instr);
+    InstrNode *new_instr;
+    Reg value;
+
+    if (instr->format == FORMAT_5) {
+        Reg dest = instr->fields.format_5.destReg;
+
+        switch (field->kind) {
+          case EA_INT:
+            new_instr = create_format6_instruction(ADD, dest, field->var, g0,
+                                                   pc);
+            break;
+          case EA_FLOAT:
+            new_instr = create_format6_instruction(FMOVS, dest, g0, field->var,
+                                                   pc);
+            break;
+          default:
+            new_instr = create_format6_instruction(FMOVD, dest, g0, field->var,
+                                                   pc);
+            break;
+        }
+    } else {
+        value = instr->fields.format_8.srcReg_2;
+
+        if (value == g0) {
+            new_instr = create_format5_instruction(ADD, field->var, g0, 0, pc);
+        } else if (field->kind == EA_INT) {
+            new_instr = create_format6_instruction(ADD, field->var, value, g0,
+                                                   pc);
+            if (Instr_IsLastUse(instr, value))
+                Instr_SetLastUseOfSrc(new_instr, 0);
+        } else {
+            new_instr = create_format6_instruction(field->kind == EA_FLOAT ?
+                                                   FMOVS : FMOVD, field->var,
+                                                   g0, value, pc);
+            if (Instr_IsLastUse(instr, value))
+                Instr_SetLastUseOfSrc(new_instr, 1);
+        }
+    }
+
+    CFG_InsertInstrAsSucc(cfg, instr, 0, new_instr);
+    CFG_RemoveInstr(cfg, instr);
+}
+
+/* Name        : replace_allocation
+   Description : try to replace an allocation with variables
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+
+   Post-condition:
+
+   Notes:
+       It returns true if the allocation is replaced.  */
+static bool
+replace_allocation(CFG *cfg, InstrNode *alloc)
+{
+    int size = cfg->sizeOfList;
+    bool *reached;
+    word *in_may, *in_must;
+    int *actions, *field_idxs;
+    int i;
+
+    reached = (bool *) FMA_calloc(sizeof(bool) * size);
+    if (!mark_reached_instrs(cfg, alloc, reached)) return false;
+    if (!collect_relevant_vars(cfg, Instr_GetRet(alloc, 0))) return false;
+
+    in_may = (word *) FMA_calloc(sizeof(word) * size);
+    in_must = (word *) FMA_calloc(sizeof(word) * size);
+    compute_reference_sets(cfg, alloc, reached, in_may, in_must);
+
+    actions = (int *) FMA_calloc(sizeof(int) * size);
+    field_idxs = (int *) FMA_calloc(sizeof(int) * size);
+    ea_num_of_fields = 0;
+
+    for (i = 0; i < size; i++) {
+        InstrNode *instr = cfg->instrList[i];
+        word used;
+
+        if (instr == NULL || !reached[i]) continue;
+
+        used = get_used_bits(instr) & in_may[i];
+        if (used == 0) continue;
+
+        /* merged with another value */
+        if (used & ~in_must[i]) return false;
+
+        actions[i] = classify_use(instr, used, &field_idxs[i]);
+        if (actions[i] < 0) return false;
+    }
+
+    if (has_overlapped_fields()) return false;
+
+    DBG(printf("EA: replacing allocation at %d with %d fields\n",
+               Instr_GetBytecodePC(alloc), ea_num_of_fields););
+
+    make_field_vars(cfg);
+
+    for (i = 0; i < size; i++) {
+        InstrNode *instr = cfg->instrList[i];
+
+        switch (actions[i]) {
+          case EA_REMOVE:
+            CFG_RemoveInstr(cfg, instr);
+            break;
+          case EA_LOAD:
+          case EA_STORE:
+            replace_field_access(cfg, instr, &ea_fields[field_idxs[i]]);
+            break;
+          default:
+            break;
+        }
+    }
+
+    insert_field_inits(cfg, alloc);
+    Instr_UnsetUnresolved(alloc);
+    CFG_RemoveInstr(cfg, alloc);
+
+    return true;
+}
+
+/* Name        : EA_replace_allocations
+   Description : replace the objects which do not escape the method
+                 with variables
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       CFG_set_variable_offsets() is done.
+   Post-condition:
+
+   Notes:
+       Only the final translation of a method is optimized.  */
+int
+EA_replace_allocations(CFG *cfg)
+{
+    int size = cfg->sizeOfList;
+    int i;
+
+    EA_replaced_alloc_num = 0;
+
+    if (has_exception_handler(CFG_GetIGRoot(cfg))) return 0;
+
+    for (i = 0; i < size; i++) {
+        InstrNode *instr = cfg->instrList[i];
+
+        if (instr == NULL || !is_allocation(instr)) continue;
+
+        if (replace_allocation(cfg, instr)) EA_replaced_alloc_num++;
+    }
+
+    return EA_replaced_alloc_num;
+}
@@ -0,0 +1,24 @@
+/* escape_analysis.h
+
+   Interface to escape analysis & scalar replacement of objects
+
+   Written by: Junpyo Lee <walker@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+#ifndef __ESCAPE_ANALYSIS_H__
+#define __ESCAPE_ANALYSIS_H__
+
+struct CFG;
+
+/* number of allocations replaced in the method being translated */
+extern int EA_replaced_alloc_num;
+
+/* Replace the objects which do not escape from the method by
+   variables holding their fields. Returns the number of replaced
+   allocations. */
+int EA_replace_allocations(struct CFG *cfg);
+
+#endif /* __ESCAPE_ANALYSIS_H__ */
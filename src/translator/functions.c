@@ -87,3 +87,26 @@ RT_check_cast( Hjava_lang_Class* class, Hjava_lang_Object* obj )
     throwException( ClassCastException );
 }
 
+
+/* Name        : RT_check_array_store
+   Description : Used for translating AASTORE bytecode when the
+                 component type of the array has no id in the display
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+       obj is not null.
+   
+   Post-condition:
+   
+   Notes:  */
+void
+RT_check_array_store( Hjava_lang_Object* array, Hjava_lang_Object* obj )
+{
+    Hjava_lang_Class* component =
+        Class_GetComponentType(Object_GetClass(array));
+
+    if (CIT_is_subclass(Object_GetClass(obj), component)) {
+        return;
+    }
+
+    throwException( ArrayStoreException );
+}
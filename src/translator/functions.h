@@ -16,6 +16,7 @@
 int RT_bin_search(int *key_array, int size, int key);
 int RT_is_instanceof(Hjava_lang_Class *class, Hjava_lang_Object *obj);
 void RT_check_cast(Hjava_lang_Class *class, Hjava_lang_Object *obj);
+void RT_check_array_store(Hjava_lang_Object *array, Hjava_lang_Object *obj);
 /* some gcc specific functions */
 extern long long    __divdi3( long long a, long long b );
 extern long long    __moddi3( long long a, long long b );
@@ -0,0 +1,199 @@
+/* jit_log.c
+
+   Machine-readable log of JIT compilation events
+
+   Written by: Byung-Sun Yang <scdoner@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#include <stdio.h>
+#include "config.h"
+#include "gtypes.h"
+#include "classMethod.h"
+#include "CFG.h"
+#include "method_inlining.h"
+#include "translate.h"
+#include "flags.h"
+#include "jit_log.h"
+
+#ifdef CUSTOMIZATION
+#include "SpecializedMethod.h"
+#endif
+
+static FILE *jit_log = NULL;
+
+static char *phase_names[JITLOG_PHASE_NUM] = {
+    "setup", "cfg", "opt", "regalloc", "codegen"
+};
+
+static
+FILE *
+open_log(void)
+{
+    if (jit_log == NULL) {
+        jit_log = fopen(flag_jit_log, "a");
+        if (jit_log == NULL) {
+            perror(flag_jit_log);
+            flag_jit_log = NULL;        // don't try again
+        }
+    }
+    return jit_log;
+}
+
+static
+unsigned long long
+diff_usec(struct timeval *from, struct timeval *to)
+{
+    return (to->tv_sec - from->tv_sec) * 1000000LL
+        + (to->tv_usec - from->tv_usec);
+}
+
+/* Print a string in double quotes.  Names in class files never
+   contain control characters, but quotes and backslashes are
+   escaped anyway. */
+static
+void
+print_string(FILE *fp, const char *str)
+{
+    putc('"', fp);
+    for (; *str != '\0'; str++) {
+        if (*str == '"' || *str == '\\') putc('\\', fp);
+        putc(*str, fp);
+    }
+    putc('"', fp);
+}
+
+static
+void
+print_method(FILE *fp, Method *method)
+{
+    fprintf(fp, "\"class\":");
+    print_string(fp, method->class->name->data);
+    fprintf(fp, ",\"method\":");
+    print_string(fp, method->name->data);
+    fprintf(fp, ",\"signature\":");
+    print_string(fp, method->signature->data);
+}
+
+/* The inlined methods are printed as a tree of
+   {"class":..., "method":..., "signature":..., "bpc":..., "inlined":[...]} */
+static
+void
+print_inline_tree(FILE *fp, InlineGraph *graph)
+{
+    InlineGraph *callee;
+
+    for (callee = IG_GetCallee(graph);
+         callee != NULL;
+         callee = IG_GetNextCallee(callee)) {
+        putc('{', fp);
+        print_method(fp, IG_GetMethod(callee));
+        fprintf(fp, ",\"bpc\":%d,\"inlined\":[", IG_GetBPC(callee));
+        print_inline_tree(fp, callee);
+        fprintf(fp, "]}");
+        if (IG_GetNextCallee(callee) != NULL) putc(',', fp);
+    }
+}
+
+static
+char *
+get_trigger(TranslationInfo *info, int tr_level)
+{
+    if (TI_IsOSREntry(info)) return "osr";
+    if (TI_IsFromException(info)) return "exception";
+    if (tr_level > 0) return "count";
+    return "call";
+}
+
+/* Name        : JitLog_print_translation
+   Description : write a record for the translation just finished
+   Maintainer  : Byung-Sun Yang <scdoner@altair.snu.ac.kr>
+   Pre-condition: flag_jit_log is set, and the CFG is not freed yet.
+
+   Post-condition:
+
+   Notes: The tier is "light" for translations which will be
+          retranslated, and "full" otherwise.  Retranslations of code
+          deoptimized by class hierarchy analysis are triggered by the
+          method count, too, and are preceded by a "deopt" record. */
+void
+JitLog_print_translation(TranslationInfo *info, CFG *cfg,
+                         JitLogRecord *record)
+{
+    Method *method = TI_GetRootMethod(info);
+    FILE *fp;
+    int tr_level;
+    int i;
+
+    if ((fp = open_log()) == NULL) return;
+
+#ifdef CUSTOMIZATION
+    tr_level = TI_GetSM(info) ? TI_GetSM(info)->tr_level : 0;
+#else
+    tr_level = method->tr_level;
+#endif
+
+    fprintf(fp, "{\"event\":\"translate\",\"start\":%llu,",
+            record->time[0].tv_sec * 1000000LL + record->time[0].tv_usec);
+    print_method(fp, method);
+#ifdef CUSTOMIZATION
+    if (TI_GetSM(info) != NULL && !SM_IsGeneralType(TI_GetSM(info))
+        && !SM_IsSpecialType(TI_GetSM(info))) {
+        fprintf(fp, ",\"receiver\":");
+        print_string(fp, SM_GetReceiverType(TI_GetSM(info))->name->data);
+    }
+#endif
+    fprintf(fp, ",\"tier\":\"%s\",\"level\":%d,\"trigger\":\"%s\"",
+            The_Need_Retranslation_Flag ? "light" : "full",
+            tr_level, get_trigger(info, tr_level));
+    fprintf(fp, ",\"bytecode\":%d,\"code\":%d",
+            Method_GetByteCodeLen(method), CFG_GetTextSegSize(cfg));
+
+    fprintf(fp, ",\"instrs\":{");
+    for (i = JITLOG_PHASE_CFG; i <= JITLOG_PHASE_REGALLOC; i++) {
+        fprintf(fp, "%s\"%s\":%d", i == JITLOG_PHASE_CFG ? "" : ",",
+                phase_names[i], record->instrs[i]);
+    }
+
+    fprintf(fp, "},\"usec\":{");
+    for (i = 0; i < JITLOG_PHASE_NUM; i++) {
+        fprintf(fp, "\"%s\":%llu,", phase_names[i],
+                diff_usec(&record->time[i], &record->time[i + 1]));
+    }
+    fprintf(fp, "\"total\":%llu}",
+            diff_usec(&record->time[0], &record->time[JITLOG_PHASE_NUM]));
+
+    fprintf(fp, ",\"inlined\":[");
+    print_inline_tree(fp, CFG_GetIGRoot(cfg));
+    fprintf(fp, "]}\n");
+    fflush(fp);
+}
+
+/* Name        : JitLog_print_deopt
+   Description : write a record for a deoptimized translation
+   Maintainer  : Byung-Sun Yang <scdoner@altair.snu.ac.kr>
+   Pre-condition: flag_jit_log is set.
+
+   Post-condition:
+
+   Notes: */
+void
+JitLog_print_deopt(Method *meth, Method *callee)
+{
+    struct timeval now;
+    FILE *fp;
+
+    if ((fp = open_log()) == NULL) return;
+
+    gettimeofday(&now, NULL);
+    fprintf(fp, "{\"event\":\"deopt\",\"start\":%llu,",
+            now.tv_sec * 1000000LL + now.tv_usec);
+    print_method(fp, meth);
+    fprintf(fp, ",\"overridden\":{");
+    print_method(fp, callee);
+    fprintf(fp, "}}\n");
+    fflush(fp);
+}
@@ -0,0 +1,51 @@
+/* jit_log.h
+
+   Header for the machine-readable log of JIT compilation events
+
+   Written by: Byung-Sun Yang <scdoner@altair.snu.ac.kr>
+
+   Copyright (C) 2000 MASS Lab., Seoul, Korea.
+
+   See the file LICENSE for usage and redistribution terms and a
+   disclaimer of all warranties. */
+
+#ifndef __JIT_LOG_H__
+#define __JIT_LOG_H__
+
+#include <sys/time.h>
+
+struct _methods;
+struct TranslationInfo;
+struct CFG;
+
+/* The log is written as one JSON object per line into the file given
+   by the -jitlog option, so that it can be summarized offline by
+   util/jitlog-summary.pl.  Each line has an "event" field, which is
+   either "translate" or "deopt". */
+
+/* phases of a translation, in the order of _translate() */
+#define JITLOG_PHASE_SETUP      0
+#define JITLOG_PHASE_CFG        1       /* CFG generation & optimizations */
+#define JITLOG_PHASE_OPT        2       /* escape analysis, inline alloc */
+#define JITLOG_PHASE_REGALLOC   3
+#define JITLOG_PHASE_CODEGEN    4       /* code generation & installation */
+#define JITLOG_PHASE_NUM        5
+
+typedef struct JitLogRecord {
+    /* time at the start of each phase, and at the end of the last one */
+    struct timeval time[JITLOG_PHASE_NUM + 1];
+
+    /* number of IR instructions at the end of CFG, OPT and REGALLOC */
+    int instrs[JITLOG_PHASE_NUM];
+} JitLogRecord;
+
+/* write a record for the translation just finished.  The CFG must not
+   be freed yet. */
+void JitLog_print_translation(struct TranslationInfo *info, struct CFG *cfg,
+                              JitLogRecord *record);
+
+/* write a record for the deoptimization of the translation of the
+   first method, caused by overriding the second one */
+void JitLog_print_deopt(struct _methods *meth, struct _methods *callee);
+
+#endif /* __JIT_LOG_H__ */
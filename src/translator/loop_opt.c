@@ -3,6 +3,8 @@
    A simple loop optimizer which does on simple loops :
       Loop Invariant Code Motion
       Register Promotion 
+      Array Bound Check Elimination
+      Strength Reduction of Array Offsets
 
    Written by: Jinpyo Park <jp@altair.snu.ac.kr>
 
@@ -23,6 +25,7 @@
 #include "method_inlining.h"
 #include "register_allocator.h"
 #include "AllocStat.h"
+#include "object.h"
 
 #define DBG(s)  
 
@@ -37,6 +40,9 @@ typedef struct {
     int mem_instr_array_index;  /* for mem instr to point its entry in mem_instr_array */
     bool is_moved;       
     int basic_block_id;         /* basic block id of this instruction */
+    int bound_check;            /* redundancy of bound check (BCE_...) */
+    int strength_reduction;     /* part of a reduced array offset (SR_...) */
+    int derived_iv;             /* the derived induction variable of SR_OFFSET */
 } LoopInstr;
 /* a post-order array of instructions */
 static LoopInstr* loop_instr_array;
@@ -103,14 +109,27 @@ static int peeled_loop_exits_idx;
 ======================================================================*/
 const int MAX_LOOP_INSTRS = 512;
 
+/* number of bound checks eliminated in the method being translated */
+int LoopOpt_eliminated_check_num = 0;
+
+/* number of array offsets strength-reduced in the method being translated */
+int LoopOpt_reduced_offset_num = 0;
+
 /*======================================================================
   function decl.
 ======================================================================*/
 static InstrNode* code_motion(CFG* cfg, InstrNode* loop_prologue_header);
+static bool is_cmvar_overflow(void);
+static int cmvar_new(int type);
+void insert_last_use_marker_at_exits(CFG* cfg, int reg);
 
 #include "loop_opt_util.ic"
 #include "loop_opt_detect.ic"
 #include "loop_opt_dfa.ic"
+#include "loop_opt_iv.ic"
+#ifdef USE_TRAP_FOR_ARRAY_BOUND_CHECK
+#include "loop_opt_bce.ic"
+#endif
 
 /* 
    Name        : LoopOpt_optimize_loop
@@ -159,6 +178,16 @@ LoopOpt_optimize_loop(CFG* cfg, InstrNode* instr,
     dataflow_analysis(cfg);
     DBG(print_loop_instr_array(););
 
+    /* strength reduction (the offsets are reduced in code motion) */
+    find_derived_ivs();
+
+#ifdef USE_TRAP_FOR_ARRAY_BOUND_CHECK
+    /* bound check elimination (the checks are removed in code motion).
+       This must precede code motion, which peels the loop and moves
+       definitions in front of it. */
+    find_redundant_bound_checks();
+#endif
+
     /* Prepare code motion */
     old_region_header = instr;
 
@@ -972,6 +1001,10 @@ code_motion(CFG* cfg, InstrNode* loop_prologue_header)
     old_loop_entry_outer_pred_instr_succ_num = 
         loop_entry_outer_pred_instr_succ_num;
 
+    /* The derived induction variables are initialized after the
+       peeled loop, so they must be connected like hoisted ones. */
+    number_of_hoists += insert_derived_iv_inits(cfg);
+
     DBG(
         {   
             FILE* fd = fopen("before.xvcg", "w+");
@@ -1000,6 +1033,21 @@ code_motion(CFG* cfg, InstrNode* loop_prologue_header)
                                          cur_instr_successor_num);
             last_instr_successor_num = cur_instr_successor_num;
         }
+        if (loop_instr_array[i].strength_reduction != SR_NONE) {
+            reduce_offset(i);
+            continue;
+        }
+        insert_derived_iv_increments(cfg, i);
+#ifdef USE_TRAP_FOR_ARRAY_BOUND_CHECK
+        if (loop_instr_array[i].bound_check != BCE_NONE) {
+            /* An invariant check remains only in the peeled loop,
+               so it must be connected. */
+            if (loop_instr_array[i].bound_check == BCE_INVARIANT)
+              number_of_hoists++;
+            remove_bound_check(cfg, i);
+            continue;
+        }
+#endif
         if (!is_eligible_for_code_motion(instr) || is_cmvar_overflow()) continue;
 
         if (is_hoistable(i)) {
@@ -18,9 +18,28 @@
 #ifdef NEW_CODE_ALLOC
 
 static const int CMA_ALLOCATION_SIZE = 1024 * 256; // size to allocate at once.
+static const int ALIGN_SIZE = 32;   // in bytes...
 static char *CMA_Start_Of_Free_Mem = NULL; // to make sure pointer arithmetic
 static int CMA_Allocated_Size = 0;
 
+/* Code blocks which are given back are kept in a free list sorted by
+   address, so that neighbouring blocks can be merged again.  The
+   links are embedded in the free blocks themselves.  Code is freed
+   rarely (only when an obsolete translation is reclaimed), so a
+   simple first-fit search is good enough. */
+typedef struct CodeFreeBlock {
+    int size;                   /* in bytes, multiple of ALIGN_SIZE */
+    struct CodeFreeBlock *next;
+} CodeFreeBlock;
+
+static CodeFreeBlock *CMA_Free_List = NULL;
+
+/* occupancy statistics of the code heap (in bytes) */
+static int CMA_Reserved_Size = 0;   // obtained from the system
+static int CMA_Used_Size = 0;       // handed out and not yet freed
+static int CMA_Peak_Used_Size = 0;
+static int CMA_Freed_Size = 0;      // total amount ever given back
+
 
 
 /* Name        : CMA_allocate_cache_aligned_memory
@@ -39,10 +58,111 @@ CMA_allocate_cache_aligned_memory(int size)
 {
     static const int BLOCK_SIZE = 32;   // in bytes...
 
+    CMA_Reserved_Size += size;
+
     return (void*) (((int) sbrk(size + BLOCK_SIZE) 
             + BLOCK_SIZE - 1) & (- BLOCK_SIZE));
 }
 
+static inline
+int
+CMA_round_size(int size)
+{
+    return (size + ALIGN_SIZE-1) & -ALIGN_SIZE;
+}
+
+static inline
+void
+CMA_account_allocation(int code_size)
+{
+    CMA_Used_Size += code_size;
+    if (CMA_Used_Size > CMA_Peak_Used_Size)
+      CMA_Peak_Used_Size = CMA_Used_Size;
+}
+
+/* Name        : CMA_insert_free_block
+   Description : put a block into the address-ordered free list
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   * block is ALIGN_SIZE aligned and code_size is a multiple of ALIGN_SIZE
+   Post-condition:
+   * adjacent free blocks are merged into one */
+static
+void
+CMA_insert_free_block(char *block, int code_size)
+{
+    CodeFreeBlock *prev = NULL;
+    CodeFreeBlock *cur = CMA_Free_List;
+    CodeFreeBlock *new_block = (CodeFreeBlock *) block;
+
+    assert(((int) block % ALIGN_SIZE) == 0);
+    assert(code_size > 0 && code_size % ALIGN_SIZE == 0);
+
+    while (cur != NULL && (char *) cur < block) {
+        prev = cur;
+        cur = cur->next;
+    }
+
+    assert(cur == NULL || block + code_size <= (char *) cur);
+    assert(prev == NULL || (char *) prev + prev->size <= block);
+
+    new_block->size = code_size;
+    new_block->next = cur;
+
+    // merge with the following block
+    if (cur != NULL && block + code_size == (char *) cur) {
+        new_block->size += cur->size;
+        new_block->next = cur->next;
+    }
+
+    // merge with the preceding block
+    if (prev != NULL && (char *) prev + prev->size == block) {
+        prev->size += new_block->size;
+        prev->next = new_block->next;
+    } else if (prev != NULL) {
+        prev->next = new_block;
+    } else {
+        CMA_Free_List = new_block;
+    }
+}
+
+/* Name        : CMA_take_free_block
+   Description : first-fit search of the free list
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   Post-condition:
+   * returns NULL if no free block is large enough */
+static
+void*
+CMA_take_free_block(int code_size)
+{
+    CodeFreeBlock *prev = NULL;
+    CodeFreeBlock *cur;
+
+    for (cur = CMA_Free_List; cur != NULL; prev = cur, cur = cur->next) {
+        if (cur->size >= code_size) {
+            CodeFreeBlock *rest;
+
+            if (cur->size == code_size) {
+                rest = cur->next;
+            } else {
+                rest = (CodeFreeBlock *) ((char *) cur + code_size);
+                rest->size = cur->size - code_size;
+                rest->next = cur->next;
+            }
+
+            if (prev != NULL)
+              prev->next = rest;
+            else
+              CMA_Free_List = rest;
+
+            return cur;
+        }
+    }
+
+    return NULL;
+}
+
 
 void
 CMA_initialize_mem_allocator()
@@ -55,10 +175,17 @@ CMA_initialize_mem_allocator()
 void *
 CMA_allocate_code_block(int size)
 {
-    static const int ALIGN_SIZE = 32;   // in bytes...
-    int code_size = (size + ALIGN_SIZE-1) & -ALIGN_SIZE;
+    int code_size = CMA_round_size(size);
         // ALIGN_SIZE bytes aligned
     int previous_allocated_size = CMA_Allocated_Size;
+    void *block;
+
+    CMA_account_allocation(code_size);
+
+    // reuse space of reclaimed code first
+    block = CMA_take_free_block(code_size);
+    if (block != NULL)
+      return block;
 
     CMA_Allocated_Size += code_size;
 
@@ -68,9 +195,18 @@ CMA_allocate_code_block(int size)
         return CMA_Start_Of_Free_Mem + previous_allocated_size;
     } else {
         if (code_size > CMA_ALLOCATION_SIZE) {
-            return CMA_allocate_cache_aligned_memory(code_size*4);
+            CMA_Allocated_Size = previous_allocated_size;
+            return CMA_allocate_cache_aligned_memory(code_size);
         }
         // code_size <= CMA_ALLOCATION_SIZE
+
+        // the unused tail of the current chunk is not lost any more
+        if (previous_allocated_size < CMA_ALLOCATION_SIZE)
+          CMA_insert_free_block(CMA_Start_Of_Free_Mem
+                                + previous_allocated_size,
+                                CMA_ALLOCATION_SIZE
+                                - previous_allocated_size);
+
         CMA_initialize_mem_allocator();
 
         CMA_Allocated_Size = code_size;
@@ -81,4 +217,83 @@ CMA_allocate_code_block(int size)
     return NULL;
 }
 
+/* Name        : CMA_free_code_block
+   Description : give a code block back to the code heap
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   * block was returned by CMA_allocate_code_block(size)
+   * no thread executes or will enter the code in the block
+   Post-condition:
+
+   Notes: the memory is never returned to the system. */
+void
+CMA_free_code_block(void *block, int size)
+{
+    int code_size = CMA_round_size(size);
+
+    assert(block != NULL);
+
+    CMA_Used_Size -= code_size;
+    CMA_Freed_Size += code_size;
+
+    CMA_insert_free_block((char *) block, code_size);
+}
+
+/* Name        : CMA_shrink_code_block
+   Description : free the tail of a code block, keeping its head
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   * block was returned by CMA_allocate_code_block(old_size)
+   * new_size <= old_size
+   Post-condition:
+   * block now occupies CMA_round_size(new_size) bytes */
+void
+CMA_shrink_code_block(void *block, int old_size, int new_size)
+{
+    int old_code_size = CMA_round_size(old_size);
+    int new_code_size = CMA_round_size(new_size);
+
+    assert(new_code_size <= old_code_size);
+
+    if (new_code_size < old_code_size)
+      CMA_free_code_block((char *) block + new_code_size,
+                          old_code_size - new_code_size);
+}
+
+/* Name        : CMA_print_statistics
+   Description : print occupancy of the code heap
+   Maintainer  : Suhyun Kim <zelo@i.am>
+   Pre-condition:
+   Post-condition:
+
+   Notes: can be registered with atexit() */
+void
+CMA_print_statistics(void)
+{
+    CodeFreeBlock *cur;
+    int free_size = 0;
+    int free_blocks = 0;
+    int largest_free = 0;
+
+    for (cur = CMA_Free_List; cur != NULL; cur = cur->next) {
+        free_size += cur->size;
+        free_blocks++;
+        if (cur->size > largest_free)
+          largest_free = cur->size;
+    }
+
+    fprintf(stderr, "code heap reserved    = %dK\n",
+            CMA_Reserved_Size / 1024);
+    fprintf(stderr, "code heap in use      = %dK (%3.2f %%, peak %dK)\n",
+            CMA_Used_Size / 1024,
+            CMA_Reserved_Size
+            ? (float) CMA_Used_Size / CMA_Reserved_Size * 100 : 0.0,
+            CMA_Peak_Used_Size / 1024);
+    fprintf(stderr, "code heap free list   = %dK in %d blocks "
+            "(largest %dK)\n",
+            free_size / 1024, free_blocks, largest_free / 1024);
+    fprintf(stderr, "code heap reclaimed   = %dK\n",
+            CMA_Freed_Size / 1024);
+}
+
 #endif
@@ -21,6 +21,9 @@
 
 void  CMA_initialize_mem_allocator();
 void* CMA_allocate_code_block(int);
+void  CMA_free_code_block(void*, int);
+void  CMA_shrink_code_block(void*, int, int);
+void  CMA_print_statistics(void);
 
 
 #endif __MEM_ALLOCATOR_FOR_CODE_H__
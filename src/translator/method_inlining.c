@@ -16,6 +16,9 @@
 #include "ArgSet.h"
 #include "InstrNode.h"
 #include "CFG.h"
+#ifdef METHOD_COUNT
+#include "bytecode_profile.h"
+#endif /* METHOD_COUNT */
 
 /* inline functions */
 #undef INLINE
@@ -25,6 +28,9 @@
 int The_Method_Inlining_Max_Size = 50;
 int The_Method_Inlining_Max_Depth = 5;
 
+/* hot call sites may inline methods this many times larger */
+#define HOT_SITE_SIZE_FACTOR 2
+
 /* static functions declarations */
 static void _print_inline_info (FILE *fp , InlineGraph *root );
 static void _print_inline_info_as_xvcg (FILE *fp , InlineGraph *root );
@@ -41,12 +47,16 @@ static void _print_inline_info_as_xvcg (FILE *fp , InlineGraph *root );
        2. inlining call depth
        3. the method is native
        4. the class of it is not processed to OK state
-       5. exception limitation (turn on off by compilation flag)  */
+       5. exception limitation (turn on off by compilation flag)
+       6. how often the call site at bpc of the caller ran before
+          retranslation. a call site which never ran is not inlined,
+          and a call site in a hot loop may inline larger methods. */
 bool
-IG_IsMethodInlinable(InlineGraph *this, Method *callee)
+IG_IsMethodInlinable(InlineGraph *this, Method *callee, int bpc)
 {
     int code_len;
     int call_depth;
+    int max_size;
     Hjava_lang_Class *callee_class;
     Method *caller;
     
@@ -57,9 +67,22 @@ IG_IsMethodInlinable(InlineGraph *this, Method *callee)
     code_len = Method_GetByteCodeLen(callee);
     callee_class = Method_GetDefiningClass(callee);
     call_depth = IG_GetDepth(this);
+    max_size = The_Method_Inlining_Max_Size;
+
+#ifdef METHOD_COUNT
+    switch (Pbc_get_frequency(caller, bpc)) {
+      case PBC_COLD:
+	return false;
+      case PBC_HOT:
+	max_size *= HOT_SITE_SIZE_FACTOR;
+	break;
+      default:
+	break;
+    }
+#endif /* METHOD_COUNT */
     
     return (flag_inlining
-	    && (Method_GetByteCodeLen(callee) < The_Method_Inlining_Max_Size)
+	    && (code_len < max_size)
 	    && !Method_IsNative(callee)
 	    && (Class_GetState(callee_class) == CSTATE_OK)
 	    && (call_depth < The_Method_Inlining_Max_Depth)
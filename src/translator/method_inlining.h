@@ -27,6 +27,17 @@ struct InstrNode;
 struct CFG;
 struct ArgSet_t;
 
+/* entry code translated for on-stack replacement at a loop header.
+   code is NULL if the entry could not be used. */
+typedef struct OSREntry {
+    int bytecodePC;
+    nativecode *code;
+    int *initMap;
+    int localVarNO;
+    int stackVarNO;
+    struct OSREntry *next;
+} OSREntry;
+
 /* method instance structure
    contains some runtime information
    such as call chain and variable map  */
@@ -48,6 +59,9 @@ typedef struct MethodInstance {
 
     char JITLevel;
 
+    /* whether the translation is going to be retranslated */
+    bool lightTranslated;
+
     /* exception related information */
     struct ExceptionInfoTable *exceptionInfoTable;
 
@@ -55,6 +69,21 @@ typedef struct MethodInstance {
     void **initEHVarMap;
     int *localVarNO;
     int *stackVarNO;
+
+    /* code and variable maps owned by the root instance of a
+       translation, kept so that they can be freed when the
+       translation becomes obsolete */
+    void *textSeg;
+    int textSegSize;
+    void *dataSeg;
+    int *varMapPool;
+
+    /* root instances of exception handlers translated for this one */
+    struct MethodInstance *handlerInstances;
+    struct MethodInstance *nextHandlerInstance;
+
+    /* entries for on-stack replacement of loops of this one */
+    OSREntry *osrEntries;
 } MethodInstance;
 
 /* inline graph structure for method inlining
@@ -112,9 +141,23 @@ void MI_SetInitEHVarMap(MethodInstance *this ,int idx ,void *map);
 int MI_GetLocalVarNO(MethodInstance *this ,int idx);
 void MI_SetLocalVarNO(MethodInstance *this ,int idx ,int localVarNO);
 int MI_GetStackVarNO(MethodInstance *this ,int idx);
+void MI_SetSegments(MethodInstance *this, void *text_seg, int text_seg_size,
+		    void *data_seg, int *var_map_pool);
+void *MI_GetTextSeg(MethodInstance *this);
+int MI_GetTextSegSize(MethodInstance *this);
+void *MI_GetDataSeg(MethodInstance *this);
+int *MI_GetVarMapPool(MethodInstance *this);
+void MI_AddHandlerInstance(MethodInstance *this, MethodInstance *handler);
+MethodInstance *MI_GetHandlerInstances(MethodInstance *this);
+MethodInstance *MI_GetNextHandlerInstance(MethodInstance *this);
+void MI_AddOSREntry(MethodInstance *this, OSREntry *entry);
+OSREntry *MI_FindOSREntry(MethodInstance *this, int bpc);
+OSREntry *MI_GetOSREntries(MethodInstance *this);
 void MI_SetLaTTeTranslated(MethodInstance *this);
 bool MI_IsLaTTeTranslated(MethodInstance *this);
 void MI_SetKaffeTranslated(MethodInstance *this);
+void MI_SetLightTranslated(MethodInstance *this);
+bool MI_IsLightTranslated(MethodInstance *this);
 bool MI_IsKaffeTranslated(MethodInstance *this);
 void IG_SetMI(InlineGraph *this ,MethodInstance *instance);
 MethodInstance *IG_GetMI(InlineGraph *this);
@@ -150,7 +193,8 @@ struct ArgSet_t *IG_GetArgSet(InlineGraph *graph);
 void IG_SetArgSet(InlineGraph *graph ,struct ArgSet_t *argset);
 
 /* functions defined in method_inlining.c files */
-bool IG_IsMethodInlinable(InlineGraph *this ,struct _methods *callee);
+bool IG_IsMethodInlinable(InlineGraph *this ,struct _methods *callee,
+			  int bpc);
 void IG_RegisterMethod(InlineGraph *this ,struct _methods *called_method ,
 		       int bpc ,struct ArgSet_t *arg_set ,
 		       struct InstrNode *instr ,int stack_top);
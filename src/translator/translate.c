@@ -28,6 +28,9 @@
 #include "register_allocator.h"
 #include "code_gen.h"
 #include "plist.h"
+#include "escape_analysis.h"
+#include "code_sequences.h"
+#include "jit_log.h"
 
 #include "flags.h"
 #ifdef USE_TRANSLATOR_STACK
@@ -39,6 +42,7 @@
 #ifdef METHOD_COUNT
 #include "classMethod.h"
 #include "reg.h"
+#include "code_sweeper.h"
 static int l_trans, f_trans, n_retrans;
 #endif
 
@@ -47,6 +51,7 @@ static int l_trans, f_trans, n_retrans;
 #endif
 #ifdef INLINE_CACHE
 #include "TypeChecker.h"
+#include "PolymorphicInlineCache.h"
 #endif
 
 #ifdef BYTECODE_PROFILE
@@ -56,6 +61,10 @@ static int l_trans, f_trans, n_retrans;
 
 unsigned long long jitStat = 0L;
 
+/* in loop_opt.c */
+extern int LoopOpt_eliminated_check_num;
+extern int LoopOpt_reduced_offset_num;
+
 extern void*    translator_stack;
 
 
@@ -126,7 +135,8 @@ print_time_log(Method *method,
                 struct timeval tv_st4, struct timeval tv_st5) {
     if (!time_log) time_log = fopen("time.log", "wa");
 
-    fprintf(time_log, "%s %s %s  %luu %luu %luu %luu %luu %luu\n",
+    // the last column tells a light (L) translation from a final (F) one
+    fprintf(time_log, "%s %s %s  %luu %luu %luu %luu %luu %luu %c\n",
             method->class->name->data,
             method->name->data,
             method->signature->data,
@@ -141,7 +151,35 @@ print_time_log(Method *method,
             (tv_st5.tv_sec - tv_st4.tv_sec) * 1000000L 
             + (tv_st5.tv_usec - tv_st4.tv_usec),
             (tv_st5.tv_sec - tv_st0.tv_sec) * 1000000L
-            + (tv_st0.tv_usec - tv_st0.tv_usec));
+            + (tv_st0.tv_usec - tv_st0.tv_usec),
+            The_Need_Retranslation_Flag ? 'L' : 'F');
+}
+
+inline static
+void
+print_opt_stats(Method *method)
+{
+    if (LoopOpt_eliminated_check_num > 0) {
+        fprintf(stderr, "newjit : %s %s %s %d bound checks eliminated\n",
+                method->class->name->data,
+                method->name->data,
+                method->signature->data,
+                LoopOpt_eliminated_check_num);
+    }
+    if (LoopOpt_reduced_offset_num > 0) {
+        fprintf(stderr, "newjit : %s %s %s %d array offsets strength-reduced\n",
+                method->class->name->data,
+                method->name->data,
+                method->signature->data,
+                LoopOpt_reduced_offset_num);
+    }
+    if (EA_replaced_alloc_num > 0) {
+        fprintf(stderr, "newjit : %s %s %s %d allocations eliminated\n",
+                method->class->name->data,
+                method->name->data,
+                method->signature->data,
+                EA_replaced_alloc_num);
+    }
 }
 
 #ifdef CUSTOMIZATION
@@ -177,6 +215,7 @@ print_jit_stats(TranslationInfo *info, struct timeval tv_st0,
     } else {
         fprintf(stderr, "\n");
     }
+    print_opt_stats(method);
 }
 #else
 inline static
@@ -192,6 +231,7 @@ print_jit_stats(Method *method, struct timeval tv_st0,
              method->name->data,
              method->signature->data,
              time, jitStat);
+    print_opt_stats(method);
 }
 #endif
 
@@ -220,6 +260,10 @@ _translate(TranslationInfo *info)
     struct timeval tv_st4;
     struct timeval tv_st5;
 
+    // for the JIT event log
+    JitLogRecord log_record;
+    bool need_phase_time;
+
     char file_name[256];
     FILE *file;
 
@@ -278,7 +322,9 @@ _translate(TranslationInfo *info)
 
 
     // some miscellaneous flags
-    if (flag_time | flag_tr_time | flag_jit) {
+    need_phase_time = flag_tr_time || flag_jit_log != NULL;
+
+    if (flag_time | flag_jit | need_phase_time) {
         gettimeofday(&tv_st0, NULL);
     }
 
@@ -294,20 +340,40 @@ _translate(TranslationInfo *info)
     // starting memory allocation system
     FMA_start();
 
-    if (flag_tr_time) {
+    LoopOpt_eliminated_check_num = 0;
+    LoopOpt_reduced_offset_num = 0;
+    EA_replaced_alloc_num = 0;
+
+    if (need_phase_time) {
         gettimeofday(&tv_st1, NULL);
     }
 
     // this function is replacement of phase1 & phase2
     CFGGen_generate_CFG(info);
 
-    if (flag_tr_time) {
+    if (need_phase_time) {
         gettimeofday(&tv_st2, NULL);
-        tv_st3 = tv_st2;
+        log_record.instrs[JITLOG_PHASE_CFG] = CFG_GetNumOfInstrs(cfg);
     }
 
     CFG_set_variable_offsets(cfg, info);
 
+    // replace objects which do not escape with variables
+    if (!flag_no_escape && !The_Need_Retranslation_Flag
+        && !TI_IsFromException(info)) {
+        EA_replace_allocations(cfg);
+    }
+
+    // allocate small objects by bumping the allocation cursor inline
+    if (!flag_no_inline_alloc) {
+        CSeq_insert_inline_allocation_code(cfg);
+    }
+
+    if (need_phase_time) {
+        gettimeofday(&tv_st3, NULL);
+        log_record.instrs[JITLOG_PHASE_OPT] = CFG_GetNumOfInstrs(cfg);
+    }
+
     if (flag_vcg) {
         sprintf(file_name, "phase2_result_%d", num);
         file = fopen(file_name, "w");
@@ -337,8 +403,9 @@ _translate(TranslationInfo *info)
     
     RegAlloc_allocate_registers_on_CFG(cfg, init_map);
 
-    if (flag_tr_time) {
+    if (need_phase_time) {
         gettimeofday(&tv_st4, NULL);
+        log_record.instrs[JITLOG_PHASE_REGALLOC] = CFG_GetNumOfInstrs(cfg);
     }
 
     if (flag_vcg) {
@@ -385,6 +452,17 @@ _translate(TranslationInfo *info)
         print_translated_method2(cfg);
     }
 
+    // the record refers to the CFG, so it is written before FMA_end()
+    if (flag_jit_log != NULL) {
+        log_record.time[JITLOG_PHASE_SETUP] = tv_st0;
+        log_record.time[JITLOG_PHASE_CFG] = tv_st1;
+        log_record.time[JITLOG_PHASE_OPT] = tv_st2;
+        log_record.time[JITLOG_PHASE_REGALLOC] = tv_st3;
+        log_record.time[JITLOG_PHASE_CODEGEN] = tv_st4;
+        gettimeofday(&log_record.time[JITLOG_PHASE_NUM], NULL);
+        JitLog_print_translation(info, cfg, &log_record);
+    }
+
     // finish memory system
     FMA_end();
 
@@ -638,6 +716,7 @@ retranslate(Method *method)
 #endif
 {
     nativecode *ocode, *ncode;
+    MethodInstance *oinstance;
     TranslationInfo info = {NULL,};
 #ifdef CUSTOMIZATION
     Hjava_lang_Class* class = SM_GetReceiverType(sm);
@@ -679,6 +758,9 @@ retranslate(Method *method)
     METHOD_NATIVECODE(selectedMethod) = NULL;
 #endif
 
+    /* The body of the old code starts right after the count code. */
+    oinstance = findMethodFromPC((uintp) ocode + COUNT_CODE_SIZE);
+
     /* Do the actual retranslation. */
     translate(&info);
 
@@ -700,6 +782,7 @@ retranslate(Method *method)
 
 #ifdef INLINE_CACHE
     TC_fixup_TypeChecker_headers(selectedMethod, ocode, ncode);
+    PIC_fixup_bodies(ocode, ncode);
 #endif
 
     generate_fixed_call_fixup(ocode, ncode);
@@ -707,13 +790,11 @@ retranslate(Method *method)
 #ifdef INLINE_CACHE
     generate_fixed_call_fixup_for_check_code(ocode, ncode);
 #endif
-    /* FIXME: we probably should be freeing all the obsolete data
-       structures such as exception information tables (like above,
-       just leaving the old data structures alone does not seem to be
-       too much of an overhead).  Also, the address range for the old
-       code should be deregistered (not really necessary currently,
-       but it will be a must when we free the slack at the end of old
-       code). */
+    /* The old code except the call site fixer above, and the data
+       structures such as exception information tables, are freed by
+       the sweeper once no stack frame refers to them. */
+    CSW_retire_code(oinstance, ocode);
+    CSW_sweep();
 
 #ifdef CUSTOMIZATION
     sm->count = 0;  
@@ -754,6 +835,9 @@ generate_count_code(Method* m, unsigned* code, unsigned* target)
     m->count = The_Retranslation_Threshold;
 #endif /* not VARIABLE_RET_COUNT */
 
+    /* back-edge counter checked at loop headers of the light code */
+    m->backEdgeCount = The_OSR_Threshold;
+
     if (code == NULL) {
         assert(0 && "currently not reachable");
     }
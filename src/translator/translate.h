@@ -34,6 +34,10 @@ typedef struct TranslationInfo {
     /* tells where translation is called. */
     TRInfo info;
 
+    /* set if an exception handler style translation is an entry for
+       on-stack replacement, which starts with an empty operand stack */
+    bool osrEntry;
+
     /* variable map at generated site */
     int *genMap;
     /* variable map at return point */
@@ -54,6 +58,7 @@ typedef struct TranslationInfo {
     int *initMap;		/* returned from stage3 */
     int localVarNO;		/* must be set during translation */
     int stackVarNO;
+    int frameSize;		/* stack frame size the code needs */
 
     struct MethodInstance *rootInstance;
     
@@ -90,12 +95,16 @@ void TI_SetLocalVarNO(TranslationInfo *info ,int number);
 int TI_GetLocalVarNO(TranslationInfo *info);
 void TI_SetStackVarNO(TranslationInfo *info ,int number);
 int TI_GetStackVarNO(TranslationInfo *info);
+void TI_SetFrameSize(TranslationInfo *info ,int size);
+int TI_GetFrameSize(TranslationInfo *info);
 bool TI_IsFromOriginal(TranslationInfo *info);
 void TI_SetFromOriginal(TranslationInfo *info);
 bool TI_IsFromObject(TranslationInfo *info);
 void TI_SetFromObject(TranslationInfo *info);
 bool TI_IsFromException(TranslationInfo *info);
 void TI_SetFromException(TranslationInfo *info);
+bool TI_IsOSREntry(TranslationInfo *info);
+void TI_SetOSREntry(TranslationInfo *info);
 struct MethodInstance *TI_GetRootMethodInstance(TranslationInfo *info);
 void TI_SetRootMethodInstance(TranslationInfo *info,
 			      struct MethodInstance *mi);
@@ -19,6 +19,8 @@
 
 #ifdef INLINE_CACHE
 #include "TypeChecker.h"
+#include "PolymorphicInlineCache.h"
+#include "SPARC_instr.h"
 #endif
 
 #ifdef CUSTOMIZATION
@@ -166,11 +168,13 @@ TD_fixup_trampoline_with_CC(CallContext* cc, Hjava_lang_Object* obj)
         return TC_GetHeader( tc );
 }
 
+/* find the method called through inline cache and translate it
+   for the receiver type if necessary */
+static
 void*
-TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
+TD_get_inlinecache_target(Hjava_lang_Object* obj, int offset, Method** methp)
 {
     SpecializedMethod* sm;
-    TypeChecker* tc;
     Hjava_lang_Class* type;
     Method* meth;
     int meth_idx;
@@ -187,8 +191,21 @@ TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
     if (SM_GetNativeCode(sm) == NULL)
       TD_invoke_translator(sm, type);
 
+    *methp = meth;
+    return SM_GetNativeCode(sm);
+}
+
+void*
+TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
+{
+    TypeChecker* tc;
+    Method* meth;
+    void* ncode;
+
+    ncode = TD_get_inlinecache_target(obj, offset, &meth);
+
     // make type-checker from type and method body
-    tc = TC_make_TypeChecker(meth, type, SM_GetNativeCode(sm));
+    tc = TC_make_TypeChecker(meth, Object_GetClass(obj), ncode);
     if (TC_GetHeader(tc) == NULL)
         return TC_MakeHeader(tc, meth, NULL);
     else 
@@ -199,10 +216,12 @@ TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
 #else /* not CUSTOMIZATION */
 
 #ifdef INLINE_CACHE
+/* find the method called through inline cache and translate it
+   if necessary */
+static
 void*
-TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
+TD_get_inlinecache_target(Hjava_lang_Object* obj, int offset, Method** methp)
 {
-    TypeChecker* tc;
     Hjava_lang_Class* type;
     Method* meth;
     int meth_idx;
@@ -225,8 +244,21 @@ TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
         METHOD_NATIVECODE(meth) = TI_GetNativeCode(info);
     }
 
+    *methp = meth;
+    return Method_GetNativeCode(meth);
+}
+
+void*
+TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
+{
+    TypeChecker* tc;
+    Method* meth;
+    void* ncode;
+
+    ncode = TD_get_inlinecache_target(obj, offset, &meth);
+
     // make type-checker from type and method body
-    tc = TC_make_TypeChecker(meth, type, Method_GetNativeCode(meth));
+    tc = TC_make_TypeChecker(meth, Object_GetClass(obj), ncode);
     if (TC_GetHeader(tc) == NULL)
         return TC_MakeHeader(tc, meth, NULL);
     else 
@@ -234,3 +266,96 @@ TD_fixup_trampoline_with_inlinecache(Hjava_lang_Object* obj, int offset)
 }
 #endif /* INLINE_CACHE */
 #endif /* not CUSTOMIZATION */
+
+#ifdef INLINE_CACHE
+/* Name        : Inline cache miss functions
+   Description : 
+   Maintainer  : Junpyo Lee <walker@altair.snu.ac.kr>
+   Pre-condition:
+   Post-condition:
+   Notes: 
+    1. General characteristics
+       - called from the assembly stubs with the receiver, the method
+         offset in dispatch table, and the address of the call site
+       - return the code to jump to.  The return address of the call
+         site is preserved by the stubs.
+    2. Sorts
+       - TD_fixup_failed_type_check : monomorphic inline cache missed.
+                                      The call site is changed to call
+                                      a PIC.
+       - TD_extend_polymorphic_inline_cache : all the entries of a PIC
+                                              missed
+    3. When PIC is full or disabled, the call site is changed to
+       'ld/ld/jmpl' sequence */
+static
+void*
+TD_add_receiver_type(PolymorphicInlineCache* pic, unsigned* call_site,
+                     Hjava_lang_Object* obj, int offset)
+{
+    Hjava_lang_Class* type = Object_GetClass(obj);
+    Method* meth;
+    void* ncode;
+
+    ncode = PIC_find_body(pic, type);
+    if (ncode != NULL)
+      return ncode;
+
+    ncode = TD_get_inlinecache_target(obj, offset, &meth);
+
+    // another thread may have extended it while translating
+    if (PIC_find_body(pic, type) == NULL
+        && !PIC_add_entry(pic, type, meth, ncode))
+      PIC_make_ld_ld_jmpl_code(call_site, offset);
+
+    return ncode;
+}
+
+void*
+TD_fixup_failed_type_check(Hjava_lang_Object* obj, int offset,
+                           unsigned* call_site, unsigned* check_code)
+{
+    unsigned* header = check_code + OFFSET_OF_CODE_START_FROM_TOP;
+    Hjava_lang_Class* check_type = (Hjava_lang_Class*) header[-2];
+    Method* check_meth = (Method*) header[-1];
+    PolymorphicInlineCache* pic;
+    int i;
+
+    pic = PIC_find_from_call_site(call_site);
+    if (pic != NULL)
+      return TD_add_receiver_type(pic, call_site, obj, offset);
+
+    if (The_PIC_Max_Size < 2
+        || (*call_site & CALL) != CALL
+        || call_site + (*call_site & 0x3fffffff) != header) {
+        if ((*call_site & CALL) == CALL)
+          PIC_make_ld_ld_jmpl_code(call_site, offset);
+        return *(void**) ((char*) obj->dtable + offset);
+    }
+
+    for (i = 0; i < TCS_GetSize(check_meth->tcs); i++) {
+        TypeChecker* tc = TCS_GetIdxElement(check_meth->tcs, i);
+
+        if (TC_GetHeader(tc) == header) {
+            pic = PIC_make_PIC(call_site, check_type, check_meth,
+                               TC_GetBody(tc));
+            return TD_add_receiver_type(pic, call_site, obj, offset);
+        }
+    }
+
+    assert(0 && "type checker of the header is not found");
+    return NULL;
+}
+
+void*
+TD_extend_polymorphic_inline_cache(Hjava_lang_Object* obj, int offset,
+                                   unsigned* call_site)
+{
+    PolymorphicInlineCache* pic = PIC_find_from_call_site(call_site);
+
+    // the call site has been changed to 'ld/ld/jmpl' in the meantime
+    if (pic == NULL)
+      return *(void**) ((char*) obj->dtable + offset);
+
+    return TD_add_receiver_type(pic, call_site, obj, offset);
+}
+#endif /* INLINE_CACHE */
@@ -25,6 +25,12 @@ void*   TD_fixup_trampoline_with_SM(struct SpecializedMethod_t*);
 #ifdef INLINE_CACHE
 void*   TD_fixup_trampoline_with_CC(struct CallContext_t*, struct Hjava_lang_Object*);
 void*   TD_fixup_trampoline_with_inlinecache(struct Hjava_lang_Object*, int);
+
+/* Invoke translator from inline cache miss */
+void*   TD_fixup_failed_type_check(struct Hjava_lang_Object*, int,
+                                   unsigned*, unsigned*);
+void*   TD_extend_polymorphic_inline_cache(struct Hjava_lang_Object*, int,
+                                           unsigned*);
 #endif
 void*   TD_fixup_trampoline_with_object(struct Hjava_lang_Object*, Method*);
 
@@ -39,6 +45,7 @@ void    dispatch_method_with_object();
 void    dispatch_method_with_CC();
 void    dispatch_method_with_inlinecache();
 void    fixup_failed_type_check();
+void    extend_polymorphic_inline_cache();
 #endif
 
 
@@ -192,8 +192,9 @@ asm(
  fixup_failed_type_check
 
    %o0 - object reference
-   %g1 - method offset 
-   %g2 - return address
+   %g2 - method offset 
+   %g3 - return address
+   %o7 - start of type check code
 ======================================================================*/
 asm(
     ".section \".text\"	\n"
@@ -201,30 +202,41 @@ asm(
     ".global fixup_failed_type_check\n" 
 
     "fixup_failed_type_check:\n"
-    "   mov     %o7, %g4\n"
-    "   mov     %g3, %o7\n"
-    //ld    [%o0],%g1
-    "   sethi   %hi(0xC2020000),%g3\n"
-//    "   or      %g3,%lo(0xC2020000),%g3\n"
-    "   st      %g3,[%o7-8]\n"          //replace instruction
-    //ld    [%g1+offset],%g1
-    "   sethi   %hi(0xC2006000),%g3\n"
-//    "   or      %g3,%lo(0xC2006000),%g3\n"
-    "   sethi   %hi(0x1FFF),%g1\n"
-    "   or      %g1,%lo(0x1FFF),%g1\n"
-    "   and     %g2,%g1,%g1\n"       //make simm13
-    "   or      %g3,%g1,%g3\n"          //%g1:method offset(byte)
-    "   st      %g3,[%o7-4]\n"          //replace instruction
-    //jmpl  %g1
-    "   sethi   %hi(0x9FC06000),%g3\n"  //0x9FC06020
-    "   or      %g3,%lo(0x9FC06000),%g3\n" //0x9FC06020
-    "   st      %g3,[%o7]\n"            //replace instruction
-    "   flush   %o7-8\n"                //self-modifying code
-    "   flush   %o7\n"                  //   -> flush icache
-    //jump to the real function
-    "   ld      [%o0],%g3\n"
-    "   ld      [%g3+%g2],%g3\n"
-    "   jmp     %g3\n"
+    "   mov     %o7, %g4\n"            //%g4 :start of type check code
+    "   mov     %g3, %o7\n"            //%o7 :return address
+    "	save	%sp, -96, %sp\n"
+    "	mov	%i0, %o0\n"             //%o0 :object reference
+    "	mov	%g2, %o1\n"             //%o1 :method offset
+    "	mov	%i7, %o2\n"             //%o2 :call site
+    "	call	TD_fixup_failed_type_check\n"
+    "	mov     %g4, %o3\n"            //%o3 :type check code
+    "	mov	%o0, %g3\n"             //%g3 :pointer to the translated code
+    "	restore\n"
+    "	jmpl    %g3,%g0\n"             //jump to the function
+    "   nop\n"
+);
+
+/*======================================================================
+ extend_polymorphic_inline_cache
+
+   %o0 - object reference
+   %g2 - method offset 
+   %o7 - return address
+======================================================================*/
+asm(
+    ".section \".text\"	\n"
+    ".align	4\n"
+    ".global extend_polymorphic_inline_cache\n" 
+
+    "extend_polymorphic_inline_cache:\n"
+    "	save	%sp, -96, %sp\n"
+    "	mov	%i0, %o0\n"             //%o0 :object reference
+    "	mov	%g2, %o1\n"             //%o1 :method offset
+    "	call	TD_extend_polymorphic_inline_cache\n"
+    "	mov	%i7, %o2\n"             //%o2 :call site
+    "	mov	%o0, %g3\n"             //%g3 :pointer to the translated code
+    "	restore\n"
+    "	jmpl    %g3,%g0\n"             //jump to the function
     "   nop\n"
 );
 #endif /* INLINE_CACHE */
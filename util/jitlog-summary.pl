@@ -0,0 +1,107 @@
+#!/usr/bin/perl
+# jitlog-summary.pl
+# Summarize the JIT event log written by "latte -jitlog file".
+#
+# Usage: jitlog-summary.pl [-n count] [file ...]
+#
+# Prints the time spent in each phase and by each tier and trigger,
+# followed by the methods which took the most translation time.
+#
+# Written by: Byung-Sun Yang <scdoner@altair.snu.ac.kr>
+#
+# Copyright (C) 2000 MASS Laboratory, Seoul National University.
+#
+# See the file LICENSE for usage and redistribution terms and a
+# disclaimer of all warranties.
+
+use strict;
+
+my $top = 20;
+if (@ARGV >= 2 && $ARGV[0] eq '-n') {
+    shift @ARGV;
+    $top = shift @ARGV;
+}
+
+my @phases = ('setup', 'cfg', 'opt', 'regalloc', 'codegen');
+
+my (%phase_usec, %tier, %trigger, %method, %deopt);
+my ($records, $total_usec, $total_bytecode, $total_code) = (0, 0, 0, 0);
+
+# Only the fields of the root method are needed, and they come before
+# the tree of inlined methods, so the first match of each is the one.
+sub field {
+    my ($line, $name) = @_;
+    return $1 if $line =~ /"$name":"((?:[^"\\]|\\.)*)"/;
+    return $1 if $line =~ /"$name":(-?\d+)/;
+    return undef;
+}
+
+while (my $line = <>) {
+    my $event = field($line, 'event');
+    next unless defined $event;
+
+    my $name = field($line, 'class') . '.' . field($line, 'method')
+        . field($line, 'signature');
+
+    if ($event eq 'deopt') {
+        $deopt{$name}++;
+        next;
+    }
+    next unless $event eq 'translate';
+
+    my ($usec) = $line =~ /"usec":\{([^}]*)\}/;
+    my $total = field($usec, 'total');
+    my $code = field($line, 'code');
+
+    $records++;
+    $total_usec += $total;
+    $total_bytecode += field($line, 'bytecode');
+    $total_code += $code;
+    foreach my $phase (@phases) {
+        $phase_usec{$phase} += field($usec, $phase);
+    }
+
+    my $key = field($line, 'tier');
+    $tier{$key}{count}++;
+    $tier{$key}{usec} += $total;
+    $key = field($line, 'trigger');
+    $trigger{$key}{count}++;
+    $trigger{$key}{usec} += $total;
+
+    $method{$name}{count}++;
+    $method{$name}{usec} += $total;
+    $method{$name}{code} += $code;
+}
+
+die "no translation records found\n" if $records == 0;
+
+sub percent {
+    return $total_usec ? 100.0 * $_[0] / $total_usec : 0;
+}
+
+printf "%d translations, %.3f s, %d bytes of bytecode, %d bytes of code\n\n",
+    $records, $total_usec / 1000000, $total_bytecode, $total_code;
+
+print "phase          usec      %\n";
+foreach my $phase (@phases) {
+    printf "%-10s %10d %6.1f\n", $phase, $phase_usec{$phase},
+        percent($phase_usec{$phase});
+}
+
+foreach my $table (['tier', \%tier], ['trigger', \%trigger]) {
+    my ($title, $h) = @$table;
+    printf "\n%-10s  count       usec      %%\n", $title;
+    foreach my $key (sort { $h->{$b}{usec} <=> $h->{$a}{usec} } keys %$h) {
+        printf "%-10s %6d %10d %6.1f\n", $key, $h->{$key}{count},
+            $h->{$key}{usec}, percent($h->{$key}{usec});
+    }
+}
+
+print "\n count deopt       usec      %   code  method\n";
+my @names = sort { $method{$b}{usec} <=> $method{$a}{usec} } keys %method;
+splice(@names, $top) if @names > $top;
+foreach my $name (@names) {
+    printf "%6d %5d %10d %6.1f %6d  %s\n", $method{$name}{count},
+        $deopt{$name} || 0, $method{$name}{usec},
+        percent($method{$name}{usec}), $method{$name}{code}, $name;
+}
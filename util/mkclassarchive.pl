@@ -0,0 +1,157 @@
+#!/usr/bin/perl
+# mkclassarchive.pl
+# Make a class archive which LaTTe maps at startup.
+#
+# Usage: mkclassarchive.pl [-classpath path] [-o archive] [list ...]
+#
+# The lists name the classes to put in the archive, one per line, as
+# either java/lang/Object or java.lang.Object.  Other entries, such as
+# resources, are named with their extension.  The entries are searched
+# for in the class path, which defaults to $CLASSPATH.  Entries in ZIP
+# files are extracted with unzip.  The archive is written to
+# classes.lca unless -o is given, and is used by putting it in the
+# class path before the locations it was made from.
+#
+# The format is described in src/runtime/classArchive.h.
+#
+# Written by: Yoo C. Chung <chungyc@altair.snu.ac.kr>
+#
+# Copyright (C) 2000 MASS Laboratory, Seoul National University.
+#
+# See the file LICENSE for usage and redistribution terms and a
+# disclaimer of all warranties.
+
+use strict;
+
+my $MAGIC = 0x4c544341;		# "LTCA"
+my $VERSION = 1;
+my $HEADER = 16;
+my $ENTRY = 16;
+
+my $classpath = $ENV{'CLASSPATH'};
+my $output = 'classes.lca';
+
+while (@ARGV >= 2 && $ARGV[0] =~ /^-/) {
+    my $opt = shift @ARGV;
+    if ($opt eq '-classpath') {
+	$classpath = shift @ARGV;
+    } elsif ($opt eq '-o') {
+	$output = shift @ARGV;
+    } else {
+	die "usage: $0 [-classpath path] [-o archive] [list ...]\n";
+    }
+}
+die "no class path given\n" unless defined $classpath;
+my @path = grep { $_ ne '' } split(/:/, $classpath);
+
+# Must be the same as hashName() in src/runtime/classArchive.c.
+sub hash_name {
+    my $hash = 0;
+    foreach my $c (unpack('C*', $_[0])) {
+	$hash = ($hash * 31 + $c) & 0xffffffff;
+    }
+    return $hash;
+}
+
+# Run unzip without a shell, so that names are passed as they are.
+# Its complaints about missing entries are thrown away.
+sub unzip_entry {
+    my ($zip, $name) = @_;
+    my $pid = open(UNZIP, '-|');
+
+    die "fork: $!\n" unless defined $pid;
+    if ($pid == 0) {
+	open(STDERR, '>/dev/null');
+	exec('unzip', '-p', $zip, $name) or exit 127;
+    }
+    binmode UNZIP;
+    local $/;
+    my $data = <UNZIP>;
+    close(UNZIP);
+    return $? == 0 ? $data : undef;
+}
+
+sub find_entry {
+    my ($name) = @_;
+
+    foreach my $dir (@path) {
+	if (-d $dir) {
+	    my $file = "$dir/$name";
+	    next unless -f $file;
+	    open(FILE, $file) or die "$file: $!\n";
+	    binmode FILE;
+	    local $/;
+	    my $data = <FILE>;
+	    close(FILE);
+	    return $data;
+	} elsif (-f $dir) {
+	    my $data = unzip_entry($dir, $name);
+	    return $data if defined $data && length($data) > 0;
+	}
+    }
+    return undef;
+}
+
+my (@names, %seen);
+while (my $line = <>) {
+    $line =~ s/^\s+//;
+    $line =~ s/\s+$//;
+    next if $line eq '' || $line =~ /^#/;
+    unless ($line =~ m{/} && $line =~ /\.[^\/]+$/) {
+	$line =~ tr{.}{/};
+	$line .= '.class';
+    }
+    push(@names, $line) unless $seen{$line}++;
+}
+
+my (@entries);
+foreach my $name (@names) {
+    my $data = find_entry($name);
+    if (!defined $data) {
+	warn "$name: not found\n";
+	next;
+    }
+    push(@entries, [$name, $data]);
+}
+my $count = @entries;
+
+my $index_size = 16;
+$index_size <<= 1 while $index_size < 2 * $count;
+
+# Lay out the entries and the names after the index, and the data
+# after the names.
+my $entries_offset = $HEADER + 4 * $index_size;
+my $names_offset = $entries_offset + $ENTRY * $count;
+my $names = '';
+foreach my $e (@entries) {
+    push(@$e, $names_offset + length($names));
+    $names .= $e->[0] . "\0";
+}
+my $data_offset = $names_offset + length($names);
+my $data = '';
+foreach my $e (@entries) {
+    my $pad = (8 - ($data_offset + length($data)) % 8) % 8;
+    $data .= "\0" x $pad;
+    push(@$e, $data_offset + length($data));
+    $data .= $e->[1];
+}
+
+my @index = (0) x $index_size;
+for (my $i = 0; $i < $count; $i++) {
+    my $h = hash_name($entries[$i][0]) & ($index_size - 1);
+    $h = ($h + 1) & ($index_size - 1) while $index[$h] != 0;
+    $index[$h] = $entries_offset + $ENTRY * $i;
+}
+
+open(OUT, ">$output") or die "$output: $!\n";
+binmode OUT;
+print OUT pack('N4', $MAGIC, $VERSION, $count, $index_size);
+print OUT pack('N*', @index);
+foreach my $e (@entries) {
+    print OUT pack('N4', $e->[2], length($e->[0]), $e->[3], length($e->[1]));
+}
+print OUT $names, $data;
+close(OUT) or die "$output: $!\n";
+
+printf "%d entries, %d bytes written to %s\n",
+    $count, $data_offset + length($data), $output;
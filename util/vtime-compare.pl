@@ -0,0 +1,103 @@
+#!/usr/bin/perl
+# vtime-compare.pl
+# Compare the times printed by "latte -vtime" under sets of options.
+#
+# Usage: vtime-compare.pl [-n runs] [-latte program] [-o options] ...
+#                         class [argument ...]
+#
+# Runs the class the given number of times (5 by default) with each
+# set of options given by -o, and prints the median of each time that
+# -vtime reports, along with the number of classes loaded before
+# main().  Without -o, the class is only run with the default options.
+# An empty set of options is written as -o ''.  The output of the
+# program itself is thrown away.  The methods which take the most
+# translation time can be found with -jitlog and jitlog-summary.pl.
+#
+# Written by: SeungIl Lee <hacker@altair.snu.ac.kr>
+#
+# Copyright (C) 2000 MASS Laboratory, Seoul National University.
+#
+# See the file LICENSE for usage and redistribution terms and a
+# disclaimer of all warranties.
+
+use strict;
+
+my $runs = 5;
+my $latte = 'latte';
+my @sets;
+
+while (@ARGV >= 2 && $ARGV[0] =~ /^-/) {
+    my $opt = shift @ARGV;
+    if ($opt eq '-n') {
+	$runs = shift @ARGV;
+    } elsif ($opt eq '-latte') {
+	$latte = shift @ARGV;
+    } elsif ($opt eq '-o') {
+	push(@sets, shift @ARGV);
+    } else {
+	die "usage: $0 [-n runs] [-latte program] [-o options] ... "
+	    . "class [argument ...]\n";
+    }
+}
+die "no class given\n" unless @ARGV;
+die "bad number of runs\n" unless $runs =~ /^\d+$/ && $runs > 0;
+@sets = ('') unless @sets;
+
+# The lines printed by print_time() in src/main.c.
+my @items = (['total', qr/^Total Execution Time : ([\d.]+) sec/],
+	     ['main', qr/^Time to main\(\) : ([\d.]+) sec/],
+	     ['classes', qr/^Time to main\(\) : [\d.]+ sec, (\d+) classes/],
+	     ['translate', qr/^Total Translation Time : ([\d.]+) sec/],
+	     ['gc', qr/^Total Garbage Collection Time : ([\d.]+) sec/]);
+
+# Run latte once, and return the values found in what it printed on
+# the standard error.
+sub run_once {
+    my @args = @_;
+    my %value;
+    my $pid = open(OUT, '-|');
+
+    die "fork: $!\n" unless defined $pid;
+    if ($pid == 0) {
+	open(STDERR, '>&STDOUT');
+	open(STDOUT, '>/dev/null');
+	exec($latte, @args) or exit 127;
+    }
+    while (my $line = <OUT>) {
+	foreach my $item (@items) {
+	    $value{$item->[0]} = $1 if $line =~ $item->[1];
+	}
+    }
+    close(OUT);
+    die "$latte exited with status $?\n" if $? != 0;
+    die "$latte did not print its times\n" unless defined $value{'total'};
+    return \%value;
+}
+
+sub median {
+    my @v = sort { $a <=> $b } @_;
+    return '-' unless @v;
+    return $v[$#v / 2] if @v % 2;
+    return ($v[@v / 2 - 1] + $v[@v / 2]) / 2;
+}
+
+printf "%-24s %9s %9s %8s %9s %9s\n",
+    'options', 'total', 'to main', 'classes', 'translate', 'gc';
+
+foreach my $set (@sets) {
+    my @options = split(' ', $set);
+    my %values;
+
+    for (my $i = 0; $i < $runs; $i++) {
+	my $value = run_once('-vtime', @options, @ARGV);
+	foreach my $item (@items) {
+	    my $name = $item->[0];
+	    push(@{$values{$name}}, $value->{$name})
+		if defined $value->{$name};
+	}
+    }
+
+    printf "%-24s %9s %9s %8s %9s %9s\n",
+	$set eq '' ? '(default)' : $set,
+	map { median(@{$values{$_->[0]} || []}) } @items;
+}